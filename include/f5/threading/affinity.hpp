@@ -0,0 +1,244 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace f5 {
+
+
+    inline namespace threading {
+
+
+        /// The CPUs in each NUMA node that this process may run on. On
+        /// systems without NUMA information all of the CPUs are in a
+        /// single node. Nodes are numbered as the kernel numbers them,
+        /// which may have gaps, so the numbers can be passed straight to
+        /// the NUMA memory APIs.
+        class topology {
+            /// A NUMA node that has CPUs this process may use
+            struct node {
+                std::size_t id;
+                std::vector<int> cpus;
+            };
+            /// Ordered by node number
+            std::vector<node> node_cpus;
+
+            /// Parse a kernel CPU list like `0-3,8-11`
+            static std::vector<int> parse(const std::string &list) {
+                std::vector<int> cpus;
+                std::size_t pos{};
+                while (pos < list.size()) {
+                    auto end = list.find(',', pos);
+                    if (end == std::string::npos) { end = list.size(); }
+                    const auto range = list.substr(pos, end - pos);
+                    const auto dash = range.find('-');
+                    if (not range.empty()) {
+                        const int first = std::stoi(range.substr(0, dash));
+                        const int last = dash == std::string::npos
+                                ? first
+                                : std::stoi(range.substr(dash + 1));
+                        for (int cpu = first; cpu <= last; ++cpu) {
+                            cpus.push_back(cpu);
+                        }
+                    }
+                    pos = end + 1;
+                }
+                return cpus;
+            }
+            /// Return true if the process is allowed to use the CPU
+            static bool allowed(int cpu) {
+#ifdef __linux__
+                static const auto mask = []() {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    if (::sched_getaffinity(0, sizeof(set), &set) != 0) {
+                        for (int c{}; c < CPU_SETSIZE; ++c) {
+                            CPU_SET(c, &set);
+                        }
+                    }
+                    return set;
+                }();
+                return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &mask);
+#else
+                return cpu >= 0;
+#endif
+            }
+
+          public:
+            /// Read the topology of the machine from the kernel's node
+            /// directories. Every `nodeN` directory is read, so node
+            /// numbers with gaps are all found. Nodes without any usable
+            /// CPUs, such as memory only nodes, are left out.
+            explicit topology(
+                    const std::filesystem::path &sysfs =
+                            "/sys/devices/system/node") {
+                std::error_code error;
+                for (std::filesystem::directory_iterator entry{sysfs, error},
+                     end;
+                     not error && entry != end; entry.increment(error)) {
+                    const auto name = entry->path().filename().string();
+                    if (name.size() <= 4 || name.compare(0, 4, "node") != 0
+                        || not std::all_of(
+                                name.begin() + 4, name.end(),
+                                [](char c) { return c >= '0' && c <= '9'; })) {
+                        continue;
+                    }
+                    std::ifstream file{entry->path() / "cpulist"};
+                    std::string list;
+                    if (not std::getline(file, list)) { continue; }
+                    std::vector<int> cpus;
+                    for (auto cpu : parse(list)) {
+                        if (allowed(cpu)) { cpus.push_back(cpu); }
+                    }
+                    if (not cpus.empty()) {
+                        node_cpus.push_back(
+                                {std::stoul(name.substr(4)), std::move(cpus)});
+                    }
+                }
+                std::sort(
+                        node_cpus.begin(), node_cpus.end(),
+                        [](const auto &l, const auto &r) {
+                            return l.id < r.id;
+                        });
+                if (node_cpus.empty()) {
+                    node_cpus.push_back({0, {}});
+                    auto &cpus = node_cpus.back().cpus;
+                    const int count =
+                            std::max(1u, std::thread::hardware_concurrency());
+                    for (int cpu{}; cpu < count; ++cpu) {
+                        if (allowed(cpu)) { cpus.push_back(cpu); }
+                    }
+                    if (cpus.empty()) { cpus.push_back(0); }
+                }
+            }
+
+            /// The number of nodes that have usable CPUs. These are
+            /// indexed from zero by `cpus` and `id`.
+            std::size_t nodes() const { return node_cpus.size(); }
+            /// The usable CPUs in the node at the index
+            const std::vector<int> &cpus(std::size_t index) const {
+                return node_cpus[index].cpus;
+            }
+            /// The kernel's number for the node at the index
+            std::size_t id(std::size_t index) const {
+                return node_cpus[index].id;
+            }
+            /// The kernel's number for the node the CPU is in, if the CPU
+            /// is usable
+            std::optional<std::size_t> node_of(int cpu) const {
+                for (auto &n : node_cpus) {
+                    for (auto c : n.cpus) {
+                        if (c == cpu) { return n.id; }
+                    }
+                }
+                return {};
+            }
+        };
+
+
+        /// Describes where the threads of a pool are run
+        struct placement {
+            enum class policy {
+                /// Leave the threads for the operating system to place
+                none,
+                /// Thread `n` is pinned to the `n`th CPU set, wrapping
+                /// around if there are more threads than sets
+                cpus,
+                /// Threads take turns between the NUMA nodes, each one
+                /// pinned to a single CPU
+                spread,
+                /// Threads fill all of the CPUs of a NUMA node before
+                /// moving on to the next one
+                compact
+            };
+
+            policy how = policy::none;
+            /// The CPU sets used by `policy::cpus`
+            std::vector<std::vector<int>> cpu_sets = {};
+
+            /// Pin the threads to the CPU sets
+            static placement pinned(std::vector<std::vector<int>> sets) {
+                return {policy::cpus, std::move(sets)};
+            }
+            /// Spread the threads across the NUMA nodes
+            static placement spread() { return {policy::spread}; }
+            /// Keep the threads together on as few NUMA nodes as possible
+            static placement compact() { return {policy::compact}; }
+
+            /// Return the CPUs that the thread should run on. An empty
+            /// vector means the thread isn't pinned.
+            std::vector<int>
+                    cpus_for(std::size_t thread, const topology &t) const {
+                switch (how) {
+                case policy::none: return {};
+                case policy::cpus:
+                    if (cpu_sets.empty()) { return {}; }
+                    return cpu_sets[thread % cpu_sets.size()];
+                case policy::spread: {
+                    const auto &cpus = t.cpus(thread % t.nodes());
+                    return {cpus[(thread / t.nodes()) % cpus.size()]};
+                }
+                case policy::compact: {
+                    std::size_t total{};
+                    for (std::size_t n{}; n < t.nodes(); ++n) {
+                        total += t.cpus(n).size();
+                    }
+                    auto index = thread % total;
+                    for (std::size_t n{};; ++n) {
+                        if (index < t.cpus(n).size()) {
+                            return {t.cpus(n)[index]};
+                        }
+                        index -= t.cpus(n).size();
+                    }
+                }
+                }
+                return {};
+            }
+        };
+
+
+        /// Restrict the calling thread to running on the CPUs. Does
+        /// nothing if the set is empty or the platform doesn't support
+        /// it.
+        inline void pin(const std::vector<int> &cpus) {
+#ifdef __linux__
+            if (cpus.empty()) { return; }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (auto cpu : cpus) { CPU_SET(cpu, &set); }
+            if (const auto error = ::pthread_setaffinity_np(
+                        ::pthread_self(), sizeof(set), &set);
+                error) {
+                throw std::system_error(error, std::system_category());
+            }
+#else
+            (void)cpus;
+#endif
+        }
+
+
+    }
+
+
+}
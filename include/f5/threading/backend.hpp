@@ -0,0 +1,55 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <boost/asio/detail/config.hpp>
+#include <boost/version.hpp>
+
+
+/// The io_uring backend is turned on by building with
+/// `BOOST_ASIO_HAS_IO_URING` and `BOOST_ASIO_DISABLE_EPOLL` defined and
+/// linking against liburing. The CMake option `F5_THREADING_IO_URING`
+/// does all of this.
+#if defined(BOOST_ASIO_HAS_IO_URING)
+static_assert(
+        BOOST_VERSION >= 107800,
+        "The io_uring backend needs Boost 1.78 or later");
+#endif
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// Return the name of the mechanism the io_services use to wait
+        /// for I/O
+        constexpr const char *reactor_backend() {
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+            return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+            return "epoll";
+#elif defined(BOOST_ASIO_HAS_KQUEUE)
+            return "kqueue";
+#elif defined(BOOST_ASIO_HAS_IOCP)
+            return "iocp";
+#elif defined(BOOST_ASIO_HAS_DEV_POLL)
+            return "/dev/poll";
+#else
+            return "select";
+#endif
+        }
+
+
+    }
+
+
+}
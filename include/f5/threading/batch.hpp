@@ -0,0 +1,163 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/queue.hpp>
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// Groups items into batches. A batch is handed to the consumers
+        /// once it holds the requested number of items, or once the
+        /// delay has passed since its first item was produced, whichever
+        /// comes first. Consumers can give the batches back once they're
+        /// done with them so that their memory is used for later ones.
+        template<typename T>
+        class batcher {
+            /// The timer's handler keeps hold of this rather than the
+            /// batcher, so one that is already queued when the batcher is
+            /// destroyed can tell it has gone
+            struct lifetime {
+                std::mutex exclusive;
+                bool alive{true};
+            };
+            std::shared_ptr<lifetime> life{std::make_shared<lifetime>()};
+            /// Mutex that controls access to the batch being built
+            std::mutex &exclusive{life->exclusive};
+            /// The number of items that fill a batch
+            std::size_t limit;
+            /// How long a partial batch can wait for more items
+            std::chrono::microseconds delay;
+            /// The batch being built
+            std::vector<T> current;
+            /// Batches handed back by the consumers, ready for reuse
+            std::vector<std::vector<T>> spare;
+            /// Fires when a partial batch has waited long enough
+            boost::asio::steady_timer timer;
+            /// Counts the batches so a timer can tell if its batch has
+            /// already been sent
+            uint64_t generation{};
+            /// The batches ready for the consumers
+            queue<std::vector<T>> batches;
+
+            /// Send the current batch, if there is one, and start a new
+            /// one. There must already be a lock covering the batch.
+            void send() {
+                if (current.empty()) { return; }
+                ++generation;
+                batches.produce(std::move(current));
+                if (spare.empty()) {
+                    current = std::vector<T>{};
+                    current.reserve(limit);
+                } else {
+                    current = std::move(spare.back());
+                    spare.pop_back();
+                }
+            }
+
+          public:
+            /// The type of the batches
+            using value_type = std::vector<T>;
+
+            /// Construct a batcher that sends batches of up to `size`
+            /// items, waiting no more than `d` for a batch to fill
+            batcher(boost::asio::io_service &ios,
+                    std::size_t size,
+                    std::chrono::microseconds d)
+            : limit{size}, delay{d}, timer{ios}, batches{ios} {
+                current.reserve(limit);
+            }
+            ~batcher() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                life->alive = false;
+            }
+
+            /// Make non-copyable and non assignable
+            batcher(const batcher &) = delete;
+            batcher &operator=(const batcher &) = delete;
+
+            /// Add an item to the current batch
+            void produce(T t) {
+                std::lock_guard<std::mutex> lock{exclusive};
+                current.push_back(std::move(t));
+                if (current.size() >= limit) {
+                    /// Any outstanding timer is for this batch and will
+                    /// see the generation has moved on when it fires
+                    send();
+                } else if (current.size() == 1) {
+                    timer.expires_after(delay);
+                    timer.async_wait([this, g = generation,
+                                      weak = std::weak_ptr<lifetime>{life}](
+                                             auto error) {
+                        auto l = weak.lock();
+                        if (error || not l) { return; }
+                        std::lock_guard<std::mutex> lock{l->exclusive};
+                        if (l->alive && g == generation) { send(); }
+                    });
+                }
+            }
+            /// Add each item consumed from the source, which may be a
+            /// queue or channel, until it is closed. The partial batch is
+            /// then sent.
+            template<typename S>
+            void feed(S &source, boost::asio::yield_context yield) {
+                try {
+                    while (true) { produce(source.consume(yield)); }
+                } catch (boost::system::system_error &) {
+                    /// The source has been closed
+                }
+                flush();
+            }
+
+            /// Send the current batch straight away
+            void flush() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                send();
+            }
+
+            /// Consume a batch, block the coroutine until one becomes
+            /// available.
+            value_type consume(boost::asio::yield_context yield) {
+                return batches.consume(yield);
+            }
+            /// Return a batch if one is available
+            std::optional<value_type> consume() { return batches.consume(); }
+
+            /// Hand back a batch that the consumer has finished with so
+            /// its memory can be reused
+            void recycle(value_type &&batch) {
+                batch.clear();
+                std::lock_guard<std::mutex> lock{exclusive};
+                spare.push_back(std::move(batch));
+            }
+
+            /// Close the batcher
+            void close() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                timer.cancel();
+                batches.close();
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,225 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/limiters.hpp>
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// What a broadcast does when its buffer is full because one or
+        /// more subscribers have fallen behind.
+        enum class lagging {
+            /// The producer yields until the slowest subscriber has
+            /// caught up enough to make space
+            block,
+            /// The oldest item is dropped and the subscribers that had
+            /// not yet seen it skip over it
+            drop
+        };
+
+
+        /// A capacity limited channel where every subscriber sees every
+        /// item. The items are stored once in a buffer shared by all of
+        /// the subscribers, each of which has its own cursor into it.
+        /// Subscribers only see items produced after they subscribed.
+        template<typename V>
+        class broadcast {
+          public:
+            /// The type of item handed to the subscribers. A single
+            /// instance is shared between all of them.
+            using value_type = std::shared_ptr<const V>;
+
+          private:
+            /// The position of a subscriber in the stream of items
+            struct cursor {
+                cursor(boost::asio::io_service &ios, uint64_t p)
+                : signal{ios}, position{p} {}
+
+                /// Wakes the subscriber when it is waiting for an item
+                threading::fd::unlimited signal;
+                /// The sequence number of the next item to deliver
+                uint64_t position;
+                /// The number of items dropped before delivery
+                uint64_t missed{};
+                /// Set whilst the subscriber is waiting on the signal
+                bool waiting{false};
+            };
+
+            /// Mutex that controls access to the buffer and cursors
+            std::mutex exclusive;
+            /// The items that have not yet been seen by all subscribers
+            boost::circular_buffer<value_type> items;
+            /// The sequence number of the item at the front of the buffer
+            uint64_t head{};
+            /// The cursors for the current subscribers
+            std::vector<cursor *> cursors;
+            /// What to do when the buffer is full
+            lagging policy;
+            /// Tells producers that space has been freed up
+            threading::fd::unlimited space;
+            /// The number of producers waiting for space
+            std::size_t blocked{};
+
+            /// Drop the items that every subscriber has seen. There must
+            /// already be a lock covering the buffer.
+            void trim() {
+                uint64_t seen = head + items.size();
+                for (auto *c : cursors) {
+                    seen = std::min(seen, c->position);
+                }
+                std::size_t freed{};
+                for (; head < seen; ++head, ++freed) { items.pop_front(); }
+                for (auto wake = std::min(freed, blocked); wake; --wake) {
+                    space.produced();
+                }
+            }
+
+          public:
+            /// Construct a broadcast with the specified capacity
+            broadcast(
+                    boost::asio::io_service &ios,
+                    std::size_t limit,
+                    lagging p = lagging::block)
+            : items(limit), policy{p}, space{ios} {}
+
+            /// Return the IO service
+            boost::asio::io_service &get_io_service() {
+                return space.get_io_service();
+            }
+            /// Return the capacity of the broadcast
+            std::size_t size() const { return items.capacity(); }
+
+            /// A subscription to the broadcast
+            class subscriber {
+                friend class broadcast;
+                broadcast *owner;
+                std::unique_ptr<cursor> place;
+
+                subscriber(broadcast &b, std::unique_ptr<cursor> c)
+                : owner{&b}, place{std::move(c)} {}
+
+              public:
+                subscriber(subscriber &&) = default;
+                subscriber &operator=(subscriber &&) = delete;
+
+                /// Stop receiving items, freeing up any space that only
+                /// this subscriber was holding on to
+                ~subscriber() {
+                    if (place) {
+                        std::lock_guard<std::mutex> lock{owner->exclusive};
+                        auto &cs = owner->cursors;
+                        cs.erase(std::find(cs.begin(), cs.end(), place.get()));
+                        owner->trim();
+                    }
+                }
+
+                /// The number of items this subscriber has missed
+                /// because it fell too far behind
+                uint64_t missed() const {
+                    std::lock_guard<std::mutex> lock{owner->exclusive};
+                    return place->missed;
+                }
+
+                /// Yield until the next item is available and return it
+                value_type consume(boost::asio::yield_context yield) {
+                    std::unique_lock<std::mutex> lock{owner->exclusive};
+                    while (true) {
+                        if (place->position < owner->head) {
+                            place->missed += owner->head - place->position;
+                            place->position = owner->head;
+                        }
+                        const auto index = place->position - owner->head;
+                        if (index < owner->items.size()) {
+                            auto item = owner->items[index];
+                            ++place->position;
+                            /// Only the subscribers at the front of the
+                            /// buffer can allow it to be trimmed
+                            if (not index) { owner->trim(); }
+                            return item;
+                        }
+                        place->waiting = true;
+                        lock.unlock();
+                        place->signal.consume(yield);
+                        lock.lock();
+                    }
+                }
+            };
+
+            /// Add a new subscriber. It will see all items produced from
+            /// now on.
+            subscriber subscribe() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                auto c = std::make_unique<cursor>(
+                        get_io_service(), head + items.size());
+                cursors.push_back(c.get());
+                return subscriber{*this, std::move(c)};
+            }
+
+            /// Deliver an item to every current subscriber. If the buffer
+            /// is full and the policy is to block then the coroutine
+            /// yields until there is space.
+            void produce(V v, boost::asio::yield_context yield) {
+                auto item = std::make_shared<const V>(std::move(v));
+                std::unique_lock<std::mutex> lock{exclusive};
+                while (items.full() && not cursors.empty()) {
+                    if (policy == lagging::drop) {
+                        items.pop_front();
+                        ++head;
+                    } else {
+                        ++blocked;
+                        lock.unlock();
+                        try {
+                            space.consume(yield);
+                        } catch (...) {
+                            lock.lock();
+                            --blocked;
+                            throw;
+                        }
+                        lock.lock();
+                        --blocked;
+                    }
+                }
+                /// With nobody subscribed there is nobody to deliver to
+                if (cursors.empty()) { return; }
+                items.push_back(std::move(item));
+                for (auto *c : cursors) {
+                    if (c->waiting) {
+                        c->waiting = false;
+                        c->signal.produced();
+                    }
+                }
+            }
+
+            /// Close the broadcast. Waiting producers and subscribers
+            /// are woken with an error.
+            void close() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                space.close();
+                for (auto *c : cursors) { c->signal.close(); }
+            }
+        };
+
+
+    }
+
+
+}
@@ -13,6 +13,10 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
 
 namespace f5 {
 
@@ -25,6 +29,9 @@ namespace f5 {
         /// similar construct which accepts unlimited items see queue.
         template<typename V>
         class channel {
+            template<typename>
+            friend class select;
+
             using queue_job = std::pair<std::unique_ptr<fd::limiter::job>, V>;
             using queue_type =
                     queue<queue_job, boost::circular_buffer<queue_job>>;
@@ -51,6 +58,32 @@ namespace f5 {
                 auto job = throttle.next_job(yield);
                 buffer.produce(std::make_pair(std::move(job), std::move(v)));
             }
+            /// Add all of the items in the range to the buffer. Capacity
+            /// for as much of the range as possible is reserved in one
+            /// go and those items are pushed into the buffer under a
+            /// single lock. The coroutine yields whenever the channel is
+            /// full. Items are moved out of the range if it is an rvalue.
+            template<typename R, typename Y>
+            void produce_many(R &&range, Y yield) {
+                auto pos = std::begin(range);
+                const auto end = std::end(range);
+                std::vector<queue_job> batch;
+                while (pos != end) {
+                    auto jobs = throttle.next_jobs(
+                            std::distance(pos, end), yield);
+                    batch.clear();
+                    batch.reserve(jobs.size());
+                    for (auto &job : jobs) {
+                        if constexpr (std::is_rvalue_reference_v<R &&>) {
+                            batch.emplace_back(std::move(job), std::move(*pos));
+                        } else {
+                            batch.emplace_back(std::move(job), *pos);
+                        }
+                        ++pos;
+                    }
+                    buffer.produce_many(std::move(batch));
+                }
+            }
 
             /// Yield until a value is available to consume. The space in
             /// the buffer is freed up straight away.
@@ -0,0 +1,76 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/queue.hpp>
+#include <f5/threading/set.hpp>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A producer/consumer queue that holds each distinct item at most
+        /// once. Producing an item that is already waiting to be consumed
+        /// does nothing. Once a consumer has taken an item it can be
+        /// produced again.
+        template<typename T, typename S = tsset<T>>
+        class dedup_queue {
+            /// The items waiting to be consumed
+            S pending;
+            /// The items in the order they are to be consumed
+            queue<T> items;
+
+          public:
+            /// The type of item that is put in the queue
+            using value_type = T;
+
+            /// Construct for the specified IO service
+            dedup_queue(boost::asio::io_service &ios) : items{ios} {}
+
+            /// Produce an item to be consumed unless it is already
+            /// waiting. Returns true if the item was added.
+            bool produce(T t) {
+                if (pending.insert_if_not_found(t)) {
+                    items.produce(std::move(t));
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+
+            /// Consume an item, block the coroutine until one becomes
+            /// available.
+            T consume(boost::asio::yield_context yield) {
+                auto t = items.consume(yield);
+                pending.remove(t);
+                return t;
+            }
+            /// Return an item if one is available
+            std::optional<T> consume() {
+                auto t = items.consume();
+                if (t) { pending.remove(*t); }
+                return t;
+            }
+
+            /// Return an estimate of the number of items waiting
+            std::size_t size() { return pending.size(); }
+
+            /// Close the queue
+            void close() { items.close(); }
+        };
+
+
+    }
+
+
+}
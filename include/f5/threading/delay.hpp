@@ -0,0 +1,152 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/queue.hpp>
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A producer/consumer queue where each item only becomes
+        /// available to the consumers at the time it is due. The pending
+        /// items are kept in a heap and a single timer is set for the
+        /// earliest of them.
+        template<typename T>
+        class delay_queue {
+          public:
+            /// The clock used for due times
+            using clock_type = std::chrono::steady_clock;
+            /// The type of item that is put in the queue
+            using value_type = T;
+
+          private:
+            /// An item waiting for its due time
+            struct pending {
+                clock_type::time_point due;
+                /// Keeps items with the same due time in production order
+                uint64_t sequence;
+                T item;
+
+                /// Orders the heap so the earliest item is at the top
+                bool operator<(const pending &p) const {
+                    return due > p.due
+                            || (due == p.due && sequence > p.sequence);
+                }
+            };
+
+            /// Held by the timer's handler in place of the queue itself.
+            /// The queue clears `alive` when it is destroyed.
+            struct lifetime {
+                std::mutex exclusive;
+                bool alive{true};
+            };
+            std::shared_ptr<lifetime> life{std::make_shared<lifetime>()};
+            /// Mutex that controls access to the heap and timer
+            std::mutex &exclusive{life->exclusive};
+            /// The items that are not yet due, kept as a heap
+            std::vector<pending> waiting;
+            /// Used to order items with the same due time
+            uint64_t produced{};
+            /// Fires when the earliest item is due
+            boost::asio::steady_timer timer;
+            /// The items that are due
+            queue<T> ready;
+
+            /// Move everything that is due into the ready queue and set
+            /// the timer for what is left. There must already be a lock
+            /// covering the heap.
+            void release() {
+                const auto now = clock_type::now();
+                while (not waiting.empty() && waiting.front().due <= now) {
+                    std::pop_heap(waiting.begin(), waiting.end());
+                    ready.produce(std::move(waiting.back().item));
+                    waiting.pop_back();
+                }
+                if (not waiting.empty()) { arm(waiting.front().due); }
+            }
+            /// Set the timer for the specified time. There must already
+            /// be a lock covering the timer.
+            void arm(clock_type::time_point when) {
+                timer.expires_at(when);
+                timer.async_wait(
+                        [this, weak = std::weak_ptr<lifetime>{life}](
+                                auto error) {
+                            auto l = weak.lock();
+                            if (error || not l) { return; }
+                            std::lock_guard<std::mutex> lock{l->exclusive};
+                            if (l->alive) { release(); }
+                        });
+            }
+
+          public:
+            /// Construct for the specified IO service
+            delay_queue(boost::asio::io_service &ios)
+            : timer{ios}, ready{ios} {}
+            ~delay_queue() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                life->alive = false;
+            }
+
+            /// Make non-copyable and non assignable
+            delay_queue(const delay_queue &) = delete;
+            delay_queue &operator=(const delay_queue &) = delete;
+
+            /// Produce an item that becomes available at the due time
+            void produce(T t, clock_type::time_point due) {
+                std::lock_guard<std::mutex> lock{exclusive};
+                const bool earliest =
+                        waiting.empty() || due < waiting.front().due;
+                waiting.push_back(pending{due, produced++, std::move(t)});
+                std::push_heap(waiting.begin(), waiting.end());
+                /// Only a new earliest item needs the timer moving
+                if (earliest) { arm(due); }
+            }
+            /// Produce an item that becomes available after the delay
+            template<typename Rep, typename Period>
+            void produce(T t, std::chrono::duration<Rep, Period> delay) {
+                produce(std::move(t), clock_type::now() + delay);
+            }
+
+            /// Consume an item, block the coroutine until one is due
+            T consume(boost::asio::yield_context yield) {
+                return ready.consume(yield);
+            }
+            /// Return an item if one is due
+            std::optional<T> consume() { return ready.consume(); }
+
+            /// The number of items that are not yet due
+            std::size_t pending_size() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                return waiting.size();
+            }
+
+            /// Close the queue. Items not yet due are discarded.
+            void close() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                timer.cancel();
+                ready.close();
+            }
+        };
+
+
+    }
+
+
+}
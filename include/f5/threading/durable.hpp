@@ -0,0 +1,477 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/spill.hpp>
+
+#include <array>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+namespace f5 {
+
+
+    inline namespace threading {
+
+
+        namespace fd {
+
+
+            /// A file that is only ever appended to, apart from being
+            /// read back in full and trimmed when it's recovered.
+            class log_file {
+                int fd;
+
+              public:
+                /// Open the file, creating it if needed
+                log_file(const std::filesystem::path &path)
+                : fd{::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644)} {
+                    if (fd < 0) {
+                        throw std::system_error(errno, std::system_category());
+                    }
+                }
+                ~log_file() { ::close(fd); }
+
+                /// Make non-copyable and non assignable
+                log_file(const log_file &) = delete;
+                log_file &operator=(const log_file &) = delete;
+
+                /// Append all of the data
+                void append(std::string_view data) {
+                    while (not data.empty()) {
+                        const auto written =
+                                ::write(fd, data.data(), data.size());
+                        if (written < 0) {
+                            if (errno == EINTR) { continue; }
+                            throw std::system_error(
+                                    errno, std::system_category());
+                        }
+                        data.remove_prefix(written);
+                    }
+                }
+                /// Wait until everything appended so far is on disk
+                void sync() {
+                    if (::fdatasync(fd) < 0) {
+                        throw std::system_error(errno, std::system_category());
+                    }
+                }
+                /// Return the whole content of the file
+                std::string read() {
+                    std::string content;
+                    std::array<char, 64 << 10> chunk;
+                    for (uint64_t offset{};;) {
+                        const auto got =
+                                ::pread(fd, chunk.data(), chunk.size(), offset);
+                        if (got < 0) {
+                            if (errno == EINTR) { continue; }
+                            throw std::system_error(
+                                    errno, std::system_category());
+                        } else if (not got) {
+                            return content;
+                        }
+                        content.append(chunk.data(), got);
+                        offset += got;
+                    }
+                }
+                /// Cut the file down to the specified size
+                void truncate(uint64_t size) {
+                    if (::ftruncate(fd, size) < 0) {
+                        throw std::system_error(errno, std::system_category());
+                    }
+                }
+            };
+
+
+            /// Make the creation and removal of the directory's entries
+            /// durable. Without this a file that has been synced can still
+            /// vanish after a power loss.
+            inline void sync_directory(const std::filesystem::path &path) {
+                const int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+                if (fd < 0) {
+                    throw std::system_error(errno, std::system_category());
+                }
+                const auto synced = ::fsync(fd);
+                const auto error = errno;
+                ::close(fd);
+                if (synced < 0) {
+                    throw std::system_error(error, std::system_category());
+                }
+            }
+
+
+        }
+
+
+    }
+
+
+    namespace boost_asio {
+
+
+        /// A producer/consumer queue that survives the process crashing.
+        /// Items are appended to a log of segment files in a directory
+        /// before they are made available to the consumers, and consumers
+        /// acknowledge each item once they are done with it. When the
+        /// queue is constructed any items that were never acknowledged
+        /// are read back from the log and delivered again, so delivery
+        /// is at least once.
+        ///
+        /// The log is synced to disk by a thread that the queue owns, so
+        /// the threads running the producers never block on the disk.
+        /// Producers that append whilst a sync is in progress wait for
+        /// the next one, which then covers all of them, so there is far
+        /// less than one sync per item under load. Acknowledgements are
+        /// synced along with the log, so only those made since the last
+        /// sync may be lost in a crash and their items delivered again.
+        template<typename T, typename Z = threading::trivial_serialiser<T>>
+        class durable_queue {
+          public:
+            /// An item along with the identifier used to acknowledge it
+            struct record {
+                uint64_t id;
+                T value;
+            };
+
+          private:
+            /// Each record in a segment has this header before the item
+            struct header {
+                uint32_t length;
+                uint32_t checksum;
+                uint64_t id;
+            };
+            /// A log file and the file of acknowledgements for it
+            struct segment {
+                segment(const std::filesystem::path &base, uint64_t first)
+                : log{base.string() + ".log"},
+                  acks{base.string() + ".ack"},
+                  first_id{first} {}
+
+                threading::fd::log_file log, acks;
+                /// The identifier of the first record in the segment
+                uint64_t first_id;
+                /// The size of the log file
+                uint64_t bytes{};
+                /// Which of the records have been acknowledged
+                std::vector<bool> acked;
+                std::size_t acked_count{};
+                /// Set when acknowledgements have been written since the
+                /// last sync
+                bool acks_written{false};
+            };
+
+            /// Mutex that controls access to the segments
+            std::mutex exclusive;
+            std::filesystem::path directory;
+            /// Segments are started again once they reach this size
+            uint64_t segment_limit;
+            Z serialiser;
+            /// The segments that still have records not acknowledged, by
+            /// the identifier of their first record. They are shared with
+            /// the committer whilst it syncs them.
+            std::map<uint64_t, std::shared_ptr<segment>> segments;
+            /// The segment new records are appended to
+            std::shared_ptr<segment> active;
+            /// Segments that are done with, for the committer to remove
+            std::vector<std::shared_ptr<segment>> retired;
+            /// The identifier the next record will get
+            uint64_t next_id{1};
+            /// All records before this are on disk
+            uint64_t synced{1};
+            /// Set when there is something for the committer to do
+            bool pending{false};
+            bool stopping{false};
+            /// The error from a failed sync, thrown to every producer
+            /// from then on
+            std::exception_ptr failure;
+            /// Wakes the committer
+            std::condition_variable requested;
+            /// The number of producers waiting for the sync to finish
+            std::size_t waiting{};
+            /// Wakes the producers that are waiting for a sync
+            threading::fd::unlimited committed;
+            /// The records that are ready to be consumed
+            queue<record> ready;
+            /// Syncs the log, acknowledgements and directory
+            std::thread committer;
+
+            /// A simple FNV-1a hash used to spot partly written records
+            static uint32_t checksum(std::string_view data) {
+                uint32_t hash = 2166136261u;
+                for (unsigned char c : data) { hash = (hash ^ c) * 16777619u; }
+                return hash;
+            }
+            /// The path, without an extension, for a segment
+            std::filesystem::path segment_path(uint64_t first) const {
+                std::array<char, 21> name{};
+                std::snprintf(
+                        name.data(), name.size(), "%020llu",
+                        static_cast<unsigned long long>(first));
+                return directory / name.data();
+            }
+            /// Start a new segment for appending to. Its directory entry
+            /// is made durable by the next sync of the directory. There
+            /// must already be a lock covering the segments.
+            void start_segment() {
+                active = std::make_shared<segment>(
+                        segment_path(next_id), next_id);
+                segments[next_id] = active;
+            }
+            /// Hand the segment to the committer for removal if it is done
+            /// with. There must already be a lock covering the segments.
+            void retire(segment &s) {
+                if (&s == active.get() || s.acked_count < s.acked.size()) {
+                    return;
+                }
+                auto pos = segments.find(s.first_id);
+                retired.push_back(std::move(pos->second));
+                segments.erase(pos);
+                request();
+            }
+            /// Ask the committer to run. There must already be a lock
+            /// covering the segments.
+            void request() {
+                pending = true;
+                requested.notify_one();
+            }
+            /// Run group commits until the queue is destroyed. Work is
+            /// gathered up under the lock but all of the syncing and file
+            /// removal is done without it.
+            void commit() {
+                std::unique_lock<std::mutex> lock{exclusive};
+                while (true) {
+                    requested.wait(
+                            lock, [this]() { return pending || stopping; });
+                    if (not pending) { return; }
+                    pending = false;
+                    const auto upto = next_id;
+                    auto log = active;
+                    std::vector<std::shared_ptr<segment>> acked;
+                    for (auto &s : segments) {
+                        if (s.second->acks_written) {
+                            s.second->acks_written = false;
+                            acked.push_back(s.second);
+                        }
+                    }
+                    auto removing = std::move(retired);
+                    retired.clear();
+                    const bool rolled = active->bytes >= segment_limit;
+                    if (rolled) {
+                        /// Appends go to a new segment whilst the full
+                        /// one is synced
+                        start_segment();
+                    }
+                    lock.unlock();
+                    try {
+                        log->log.sync();
+                        for (auto &s : acked) { s->acks.sync(); }
+                        for (auto &s : removing) {
+                            const auto base =
+                                    segment_path(s->first_id).string();
+                            std::filesystem::remove(base + ".log");
+                            std::filesystem::remove(base + ".ack");
+                        }
+                        if (rolled || not removing.empty()) {
+                            threading::fd::sync_directory(directory);
+                        }
+                        lock.lock();
+                        synced = upto;
+                        /// Its records may all have been acknowledged
+                        /// whilst it was still being appended to
+                        if (rolled) { retire(*log); }
+                    } catch (...) {
+                        if (not lock.owns_lock()) { lock.lock(); }
+                        if (not failure) { failure = std::current_exception(); }
+                    }
+                    for (; waiting; --waiting) { committed.produced(); }
+                }
+            }
+            /// Read back a segment found on disk and queue up the records
+            /// that have not been acknowledged
+            void recover(uint64_t first) {
+                auto s = std::make_shared<segment>(segment_path(first), first);
+                const auto content = s->log.read();
+                std::string_view remaining{content};
+                while (remaining.size() >= sizeof(header)) {
+                    header h;
+                    std::memcpy(&h, remaining.data(), sizeof(header));
+                    if (remaining.size() < sizeof(header) + h.length) { break; }
+                    const auto payload =
+                            remaining.substr(sizeof(header), h.length);
+                    if (h.id != first + s->acked.size()
+                        || checksum(payload) != h.checksum) {
+                        break;
+                    }
+                    s->acked.push_back(false);
+                    remaining.remove_prefix(sizeof(header) + h.length);
+                }
+                /// Anything after the last whole record was being written
+                /// when the process stopped
+                s->bytes = content.size() - remaining.size();
+                if (not remaining.empty()) { s->log.truncate(s->bytes); }
+
+                const auto acks = s->acks.read();
+                for (std::size_t pos{}; pos + sizeof(uint64_t) <= acks.size();
+                     pos += sizeof(uint64_t)) {
+                    uint64_t id;
+                    std::memcpy(&id, acks.data() + pos, sizeof(uint64_t));
+                    if (id >= first && id - first < s->acked.size()
+                        && not s->acked[id - first]) {
+                        s->acked[id - first] = true;
+                        ++s->acked_count;
+                    }
+                }
+
+                std::string_view records{content.data(), s->bytes};
+                for (std::size_t index{}; index < s->acked.size(); ++index) {
+                    header h;
+                    std::memcpy(&h, records.data(), sizeof(header));
+                    if (not s->acked[index]) {
+                        ready.produce(record{
+                                h.id,
+                                serialiser.load(records.substr(
+                                        sizeof(header), h.length))});
+                    }
+                    records.remove_prefix(sizeof(header) + h.length);
+                }
+                next_id = std::max(next_id, first + s->acked.size());
+                auto &recovered = *s;
+                segments[first] = std::move(s);
+                retire(recovered);
+            }
+
+          public:
+            /// Construct a queue that keeps its log in the directory. Any
+            /// items left in the log from before are queued up first.
+            durable_queue(
+                    boost::asio::io_service &ios,
+                    std::filesystem::path d,
+                    uint64_t limit = 64 << 20,
+                    Z z = Z())
+            : directory{std::move(d)},
+              segment_limit{limit},
+              serialiser{std::move(z)},
+              committed{ios},
+              ready{ios} {
+                std::filesystem::create_directories(directory);
+                std::vector<uint64_t> found;
+                for (auto &entry :
+                     std::filesystem::directory_iterator{directory}) {
+                    if (entry.path().extension() != ".log") { continue; }
+                    /// Only segment names are read, other files are left
+                    /// alone
+                    const auto stem = entry.path().stem().string();
+                    uint64_t first{};
+                    const auto [end, error] = std::from_chars(
+                            stem.data(), stem.data() + stem.size(), first);
+                    if (error == std::errc{} && end == stem.data() + stem.size()
+                        && not stem.empty()) {
+                        found.push_back(first);
+                    }
+                }
+                std::sort(found.begin(), found.end());
+                std::lock_guard<std::mutex> lock{exclusive};
+                for (auto first : found) { recover(first); }
+                synced = next_id;
+                start_segment();
+                request();
+                committer = std::thread{[this]() { commit(); }};
+            }
+            ~durable_queue() {
+                {
+                    std::lock_guard<std::mutex> lock{exclusive};
+                    stopping = true;
+                    requested.notify_one();
+                }
+                committer.join();
+            }
+
+            /// Make non-copyable and non assignable
+            durable_queue(const durable_queue &) = delete;
+            durable_queue &operator=(const durable_queue &) = delete;
+
+            /// Append the item to the log and yield until it is on disk,
+            /// after which it is made available to the consumers. If the
+            /// log can't be synced the error is thrown.
+            void produce(T t, boost::asio::yield_context yield) {
+                std::string bytes(sizeof(header), '\0');
+                serialiser.save(t, bytes);
+                header h{};
+                h.length = bytes.size() - sizeof(header);
+                h.checksum = checksum(std::string_view{bytes}.substr(
+                        sizeof(header)));
+
+                std::unique_lock<std::mutex> lock{exclusive};
+                h.id = next_id++;
+                std::memcpy(bytes.data(), &h, sizeof(header));
+                active->log.append(bytes);
+                active->bytes += bytes.size();
+                active->acked.push_back(false);
+
+                request();
+
+                /// Wait for a sync that covers this record
+                while (synced <= h.id) {
+                    if (failure) { std::rethrow_exception(failure); }
+                    ++waiting;
+                    lock.unlock();
+                    committed.consume(yield);
+                    lock.lock();
+                }
+                lock.unlock();
+                ready.produce(record{h.id, std::move(t)});
+            }
+
+            /// Consume a record, block the coroutine until one becomes
+            /// available.
+            record consume(boost::asio::yield_context yield) {
+                return ready.consume(yield);
+            }
+            /// Return a record if one is available
+            std::optional<record> consume() { return ready.consume(); }
+
+            /// Acknowledge that the record has been dealt with so it
+            /// won't be delivered again after a restart. The
+            /// acknowledgement is synced to disk along with the next sync
+            /// of the log, which this asks for.
+            void ack(uint64_t id) {
+                std::lock_guard<std::mutex> lock{exclusive};
+                auto pos = segments.upper_bound(id);
+                if (pos == segments.begin()) { return; }
+                auto &s = *(--pos)->second;
+                const auto index = id - s.first_id;
+                if (index >= s.acked.size() || s.acked[index]) { return; }
+                s.acks.append(std::string_view{
+                        reinterpret_cast<const char *>(&id), sizeof(id)});
+                s.acked[index] = true;
+                ++s.acked_count;
+                s.acks_written = true;
+                request();
+                retire(s);
+            }
+
+            /// Close the queue
+            void close() {
+                committed.close();
+                ready.close();
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,114 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/waiters.hpp>
+
+#include <boost/coroutine/exceptions.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A one-shot event that both threads and coroutines can wait on.
+        /// Unlike `f5::sync` a coroutine waiting for it doesn't block its
+        /// thread, so it is safe to use from inside a reactor pool. A
+        /// coroutine waiting costs no allocation and any number of them
+        /// may wait. Once the event is done it stays done and all waits
+        /// return straight away.
+        class event {
+            std::mutex exclusive;
+            std::condition_variable signalled;
+            detail::waiters coroutines;
+            bool finished{false};
+            std::exception_ptr error;
+
+            /// Finish the event, waking everything that is waiting
+            void complete(std::exception_ptr e) {
+                auto woken = [&]() {
+                    std::lock_guard<std::mutex> lock{exclusive};
+                    if (not finished) {
+                        finished = true;
+                        error = std::move(e);
+                    }
+                    return coroutines.take();
+                }();
+                signalled.notify_all();
+                woken.resume();
+            }
+            /// Rethrow the exception the event finished with, if any.
+            /// There must be a lock covering the event.
+            void check() const {
+                if (error) { std::rethrow_exception(error); }
+            }
+
+          public:
+            event() = default;
+
+            /// Make non-copyable and non assignable
+            event(const event &) = delete;
+            event &operator=(const event &) = delete;
+
+            /// Mark the event as done
+            void done() { complete(nullptr); }
+            /// Mark the event as done with an exception that the waits
+            /// will throw
+            void fail(std::exception_ptr e) { complete(std::move(e)); }
+
+            /// True once the event is done
+            bool is_done() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                return finished;
+            }
+
+            /// Block the thread until the event is done
+            void wait() {
+                std::unique_lock<std::mutex> lock{exclusive};
+                signalled.wait(lock, [this]() { return finished; });
+                check();
+            }
+            /// Suspend the coroutine until the event is done
+            void wait(boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                if (not finished) {
+                    coroutines.wait(lock, yield);
+                    lock.lock();
+                }
+                check();
+            }
+
+            /// Wrap the operation so that the event is done when it
+            /// returns, or fails with the exception that it throws
+            template<typename F>
+            auto operator()(F op) {
+                return [this, op = std::move(op)](auto &&... s) mutable {
+                    try {
+                        op(std::forward<decltype(s)>(s)...);
+                        done();
+                    } catch (boost::coroutines::detail::forced_unwind &) {
+                        done();
+                        throw;
+                    } catch (...) { fail(std::current_exception()); }
+                };
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,367 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/core/demangle.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+
+namespace f5 {
+
+
+    inline namespace threading {
+
+
+        /// A log-linear histogram in the style of HDR histograms. Values
+        /// are counted in buckets that are between about 3% and 6% of
+        /// their values wide, so the whole range of a `uint64_t` fits in
+        /// under a thousand buckets.
+        /// Recording is a single relaxed atomic increment so it is safe
+        /// to take a snapshot whilst values are being recorded.
+        class histogram {
+            /// Values below this are counted exactly
+            static constexpr uint64_t exact = 32;
+            /// The number of buckets each power of two is split into
+            static constexpr uint64_t half = exact / 2;
+            static constexpr std::size_t bucket_count = 976;
+
+            std::array<std::atomic<uint64_t>, bucket_count> counts{};
+
+          public:
+            /// The bucket the value is counted in
+            static std::size_t bucket_of(uint64_t value) {
+                if (value < exact) { return value; }
+                std::size_t msb{};
+                for (auto v = value; v >>= 1;) { ++msb; }
+                /// Shift so that the top five bits are left, putting the
+                /// value in the range `[half, exact)`
+                const auto shift = msb - 4;
+                return shift * half + (value >> shift);
+            }
+            /// The smallest value that is counted in the bucket
+            static uint64_t lowest(std::size_t bucket) {
+                if (bucket < exact) { return bucket; }
+                const auto shift = bucket / half - 1;
+                return (bucket % half + half) << shift;
+            }
+
+            /// The counts from a histogram at one point in time
+            class values {
+                std::vector<uint64_t> counts;
+                friend class histogram;
+
+              public:
+                values() : counts(bucket_count) {}
+
+                /// The number of values recorded
+                uint64_t count() const {
+                    uint64_t total{};
+                    for (auto c : counts) { total += c; }
+                    return total;
+                }
+                /// The value that the fraction of recorded values are at
+                /// or below, to the accuracy of the buckets. Zero if there
+                /// are no values.
+                uint64_t percentile(double fraction) const {
+                    const auto total = count();
+                    if (not total) { return 0; }
+                    const auto wanted =
+                            std::max(uint64_t{1},
+                                     static_cast<uint64_t>(fraction * total));
+                    uint64_t seen{};
+                    for (std::size_t bucket{}; bucket != bucket_count;
+                         ++bucket) {
+                        seen += counts[bucket];
+                        if (seen >= wanted) {
+                            return bucket + 1 == bucket_count
+                                    ? lowest(bucket)
+                                    : lowest(bucket + 1) - 1;
+                        }
+                    }
+                    return lowest(bucket_count - 1);
+                }
+                /// The largest value recorded, to the accuracy of the
+                /// buckets
+                uint64_t max() const { return percentile(1.0); }
+                /// Add the counts from another set of values
+                values &operator+=(const values &v) {
+                    for (std::size_t b{}; b != bucket_count; ++b) {
+                        counts[b] += v.counts[b];
+                    }
+                    return *this;
+                }
+            };
+
+            /// Count a value
+            void record(uint64_t value) {
+                counts[bucket_of(value)].fetch_add(
+                        1, std::memory_order_relaxed);
+            }
+            /// Count a duration in nanoseconds
+            template<typename Rep, typename Period>
+            void record(std::chrono::duration<Rep, Period> d) {
+                const auto ns =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(d)
+                                .count();
+                record(static_cast<uint64_t>(std::max(decltype(ns){}, ns)));
+            }
+
+            /// Return the counts recorded so far
+            values snapshot() const {
+                values v;
+                for (std::size_t b{}; b != bucket_count; ++b) {
+                    v.counts[b] = counts[b].load(std::memory_order_relaxed);
+                }
+                return v;
+            }
+        };
+
+
+    }
+
+
+    namespace boost_asio {
+
+
+        /// Settings for the instrumentation of a reactor pool
+        struct instrumentation_options {
+            /// Handlers that run for longer than this are counted as long
+            std::chrono::nanoseconds long_handler =
+                    std::chrono::milliseconds{10};
+            /// Called with the run time and label of each long handler, on
+            /// the thread that ran it. The label is empty if the handler
+            /// wasn't given one.
+            std::function<void(std::chrono::nanoseconds, std::string_view)>
+                    on_long_handler = {};
+            /// How often the event loop lag is sampled. Zero turns the
+            /// sampling off.
+            std::chrono::nanoseconds lag_interval =
+                    std::chrono::milliseconds{100};
+        };
+
+
+        /// Measures how long handlers wait in an io_service before they
+        /// run and how long they then take. Work posted through the pool
+        /// is always timed. Other handlers, such as coroutine resumptions
+        /// and handlers posted straight to the io_service, are timed when
+        /// a thread finds them waiting after running another handler, but
+        /// not when one wakes an idle thread, as the thread can't tell how
+        /// much of its wait was spent idle. The wait can only be measured
+        /// for work posted through the pool. Measurements are kept in
+        /// histograms per thread so threads don't contend when recording
+        /// them. A timer also samples the event loop lag by measuring how
+        /// long a posted handler waits to run, which shows up stalls
+        /// whichever handler causes them.
+        class instrumentation {
+            using clock_type = std::chrono::steady_clock;
+
+            /// The measurements for one thread
+            struct slot {
+                std::thread::id thread = std::this_thread::get_id();
+                histogram delay, run;
+                std::atomic<uint64_t> long_handlers{};
+            };
+
+            instrumentation_options options;
+            /// Identifies this instance to the per-thread slot cache
+            const uint64_t id;
+            /// Mutex that controls access to the slots and timer
+            std::mutex exclusive;
+            std::vector<std::unique_ptr<slot>> slots;
+            histogram lag;
+            boost::asio::steady_timer timer;
+            bool closed{false};
+
+            static uint64_t next_id() {
+                static std::atomic<uint64_t> ids{};
+                return ++ids;
+            }
+            /// The label of the handler running on this thread
+            static const char *&current() {
+                static thread_local const char *running = nullptr;
+                return running;
+            }
+            /// True whilst `time` is measuring the handler running on this
+            /// thread
+            static bool &timing() {
+                static thread_local bool measuring = false;
+                return measuring;
+            }
+            /// Return the slot for the current thread
+            slot &local() {
+                /// The slots this thread has, by instrumentation id. A
+                /// thread will normally only ever have one.
+                static thread_local std::vector<std::pair<uint64_t, slot *>>
+                        cache;
+                for (auto &c : cache) {
+                    if (c.first == id) { return *c.second; }
+                }
+                std::lock_guard<std::mutex> lock{exclusive};
+                slots.push_back(std::make_unique<slot>());
+                cache.emplace_back(id, slots.back().get());
+                return *slots.back();
+            }
+            /// Record how long the handler that started took
+            void finished(slot &s, clock_type::time_point started) {
+                const auto took =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                clock_type::now() - started);
+                s.run.record(took);
+                if (took > options.long_handler) {
+                    s.long_handlers.fetch_add(1, std::memory_order_relaxed);
+                    if (options.on_long_handler) {
+                        const auto name = current();
+                        options.on_long_handler(
+                                took,
+                                name ? boost::core::demangle(name)
+                                     : std::string{});
+                    }
+                }
+            }
+            /// Set the timer for the next lag sample. There must already
+            /// be a lock covering the timer.
+            void sample(boost::asio::io_service &ios) {
+                timer.expires_after(options.lag_interval);
+                timer.async_wait([this, &ios](auto error) {
+                    if (error) { return; }
+                    boost::asio::post(
+                            ios, [this, &ios, posted = clock_type::now()]() {
+                                lag.record(clock_type::now() - posted);
+                                std::lock_guard<std::mutex> lock{exclusive};
+                                if (not closed) { sample(ios); }
+                            });
+                });
+            }
+
+          public:
+            /// The measurements for a thread
+            struct thread_statistics {
+                std::thread::id thread;
+                /// How long handlers waited before they ran
+                histogram::values delay;
+                /// How long handlers took to run
+                histogram::values run;
+                /// The number of handlers that took too long
+                uint64_t long_handlers;
+            };
+            /// All of the measurements at one point in time
+            struct statistics {
+                /// Samples of how long a handler waits to run
+                histogram::values lag;
+                std::vector<thread_statistics> threads;
+            };
+
+            /// Construct to measure the handlers for the io_service
+            instrumentation(
+                    boost::asio::io_service &ios, instrumentation_options o)
+            : options{std::move(o)}, id{next_id()}, timer{ios} {
+                if (options.lag_interval.count() > 0) {
+                    std::lock_guard<std::mutex> lock{exclusive};
+                    sample(ios);
+                }
+            }
+
+            /// Make non-copyable and non assignable
+            instrumentation(const instrumentation &) = delete;
+            instrumentation &operator=(const instrumentation &) = delete;
+
+            /// Name the handler running on this thread in the reports of
+            /// long handlers. A coroutine can call this after it resumes.
+            /// The name must stay valid until the handler has finished.
+            static void label(const char *name) { current() = name; }
+
+            /// Return a handler that runs the function and measures how
+            /// long it waited. It is labelled with the function's type,
+            /// which names the function that a lambda was written in. The
+            /// handler times itself if it isn't run inside `time`.
+            template<typename F>
+            auto wrap(F f) {
+                return [this, f = std::move(f),
+                        posted = clock_type::now()]() mutable {
+                    auto &s = local();
+                    const auto started = clock_type::now();
+                    s.delay.record(started - posted);
+                    label(typeid(F).name());
+                    if (timing()) {
+                        f();
+                    } else {
+                        try {
+                            f();
+                        } catch (...) {
+                            finished(s, started);
+                            throw;
+                        }
+                        finished(s, started);
+                    }
+                };
+            }
+            /// Call the runner, which runs at most one handler without
+            /// blocking and returns how many it ran, and measure the
+            /// handler
+            template<typename R>
+            std::size_t time(R runner) {
+                auto &s = local();
+                label(nullptr);
+                const auto started = clock_type::now();
+                std::size_t ran{};
+                timing() = true;
+                try {
+                    ran = runner();
+                } catch (...) {
+                    timing() = false;
+                    finished(s, started);
+                    throw;
+                }
+                timing() = false;
+                if (ran) { finished(s, started); }
+                return ran;
+            }
+
+            /// Return the measurements taken so far
+            statistics snapshot() {
+                statistics stats;
+                stats.lag = lag.snapshot();
+                std::lock_guard<std::mutex> lock{exclusive};
+                for (auto &s : slots) {
+                    stats.threads.push_back(
+                            {s->thread, s->delay.snapshot(), s->run.snapshot(),
+                             s->long_handlers.load()});
+                }
+                return stats;
+            }
+
+            /// Stop sampling the lag
+            void close() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                closed = true;
+                timer.cancel();
+            }
+        };
+
+
+    }
+
+
+}
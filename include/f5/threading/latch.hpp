@@ -0,0 +1,239 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/event.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        namespace detail {
+
+
+            static_assert(
+                    sizeof(std::atomic<uint32_t>) == sizeof(uint32_t)
+                            && std::atomic<uint32_t>::is_always_lock_free,
+                    "A futex needs a plain 32 bit word");
+
+            /// Block the thread whilst the word still has the expected
+            /// value. May return early, so the caller must check again.
+            inline void
+                    futex_wait(std::atomic<uint32_t> &word, uint32_t expected) {
+#ifdef __linux__
+                if (::syscall(
+                            SYS_futex, reinterpret_cast<uint32_t *>(&word),
+                            FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0)
+                            == -1
+                    && errno != EAGAIN && errno != EINTR) {
+                    throw std::system_error(errno, std::system_category());
+                }
+#else
+                if (word.load() == expected) { std::this_thread::yield(); }
+#endif
+            }
+            /// Wake every thread blocked on the word
+            inline void futex_wake(std::atomic<uint32_t> &word) {
+#ifdef __linux__
+                if (::syscall(
+                            SYS_futex, reinterpret_cast<uint32_t *>(&word),
+                            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0)
+                    == -1) {
+                    throw std::system_error(errno, std::system_category());
+                }
+#else
+                (void)word;
+#endif
+            }
+
+
+        }
+
+
+        /// A single use countdown. Each arrival costs one atomic decrement
+        /// and the arrival that takes the count to zero wakes all of the
+        /// waiters at once. Threads block on a futex whilst coroutines are
+        /// suspended without blocking their thread. The latch must not be
+        /// destroyed until the last `count_down` has returned.
+        class latch {
+            std::atomic<uint32_t> remaining;
+            std::mutex exclusive;
+            detail::waiters coroutines;
+
+            /// Wake everything that is waiting
+            void complete() {
+                detail::futex_wake(remaining);
+                std::unique_lock<std::mutex> lock{exclusive};
+                auto woken = coroutines.take();
+                lock.unlock();
+                woken.resume();
+            }
+
+          public:
+            /// Construct a latch that is done after the number of arrivals
+            explicit latch(uint32_t count) : remaining{count} {}
+
+            /// Make non-copyable and non assignable
+            latch(const latch &) = delete;
+            latch &operator=(const latch &) = delete;
+
+            /// Arrive, without waiting
+            void count_down(uint32_t n = 1) {
+                if (remaining.fetch_sub(n) == n) { complete(); }
+            }
+
+            /// True once the count has reached zero
+            bool try_wait() const { return remaining.load() == 0; }
+
+            /// Block the thread until the count reaches zero
+            void wait() {
+                for (auto left = remaining.load(); left;
+                     left = remaining.load()) {
+                    detail::futex_wait(remaining, left);
+                }
+            }
+            /// Suspend the coroutine until the count reaches zero
+            void wait(boost::asio::yield_context yield) {
+                if (try_wait()) { return; }
+                std::unique_lock<std::mutex> lock{exclusive};
+                /// Check again now the lock is held. If the count is
+                /// still not zero then the completion will find this
+                /// coroutine in the list.
+                if (try_wait()) { return; }
+                coroutines.wait(lock, yield);
+            }
+
+            /// Arrive and then block the thread until the count is zero
+            void arrive_and_wait() {
+                count_down();
+                wait();
+            }
+            /// Arrive and then suspend the coroutine until the count is
+            /// zero
+            void arrive_and_wait(boost::asio::yield_context yield) {
+                count_down();
+                wait(yield);
+            }
+        };
+
+
+        /// A reusable barrier for a fixed number of participants. Each
+        /// phase finishes when all of them have arrived, and the barrier
+        /// then resets for the next phase. The phase and the arrivals
+        /// still expected share a single word, so an arrival is one
+        /// atomic decrement and the last one starts the next phase and
+        /// wakes the waiters with one more atomic operation. The barrier
+        /// must not be destroyed until the last `arrive` has returned.
+        class barrier {
+            static constexpr uint32_t count_bits = 16;
+            static constexpr uint32_t count_mask = (1u << count_bits) - 1;
+            static constexpr uint32_t phase_unit = 1u << count_bits;
+
+            const uint32_t participants;
+            /// The phase in the top bits and the remaining arrivals for
+            /// it in the bottom bits
+            std::atomic<uint32_t> state;
+            std::mutex exclusive;
+            detail::waiters coroutines;
+
+            static uint32_t checked(uint32_t count) {
+                if (count == 0 || count > count_mask) {
+                    throw std::invalid_argument{
+                            "A barrier needs between 1 and 65535 "
+                            "participants"};
+                }
+                return count;
+            }
+            /// True whilst the phase hasn't finished
+            bool waiting(uint32_t phase) const {
+                return state.load() >> count_bits == phase;
+            }
+
+          public:
+            /// The phase that an arrival was part of
+            using arrival_token = uint32_t;
+
+            /// Construct a barrier for the number of participants
+            explicit barrier(uint32_t count)
+            : participants{checked(count)}, state{participants} {}
+
+            /// Make non-copyable and non assignable
+            barrier(const barrier &) = delete;
+            barrier &operator=(const barrier &) = delete;
+
+            /// Arrive at the barrier without waiting. The token can then
+            /// be used to wait for the phase to finish.
+            arrival_token arrive() {
+                const auto before = state.fetch_sub(1);
+                const auto phase = before >> count_bits;
+                if ((before & count_mask) == 1) {
+                    /// Last to arrive, so move on to the next phase. The
+                    /// coroutines waiting for this phase are taken before
+                    /// the next phase starts so that none waiting for the
+                    /// next one can be mixed in with them.
+                    std::unique_lock<std::mutex> lock{exclusive};
+                    auto woken = coroutines.take();
+                    state.fetch_add(phase_unit + participants);
+                    lock.unlock();
+                    detail::futex_wake(state);
+                    woken.resume();
+                }
+                return phase;
+            }
+
+            /// Block the thread until the phase has finished
+            void wait(arrival_token phase) {
+                for (auto s = state.load(); s >> count_bits == phase;
+                     s = state.load()) {
+                    detail::futex_wait(state, s);
+                }
+            }
+            /// Suspend the coroutine until the phase has finished
+            void wait(arrival_token phase, boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{exclusive, std::defer_lock};
+                while (waiting(phase)) {
+                    lock.lock();
+                    if (not waiting(phase)) { return; }
+                    coroutines.wait(lock, yield);
+                }
+            }
+
+            /// Arrive and then block the thread until everybody else has
+            void arrive_and_wait() { wait(arrive()); }
+            /// Arrive and then suspend the coroutine until everybody else
+            /// has
+            void arrive_and_wait(boost::asio::yield_context yield) {
+                wait(arrive(), yield);
+            }
+        };
+
+
+    }
+
+
+}
@@ -9,6 +9,8 @@
 #pragma once
 
 
+#include <f5/threading/backend.hpp>
+
 #include <boost/asio.hpp>
 #include <boost/range.hpp> // Works around a bug in Boost 1.72.0
 #include <boost/asio/spawn.hpp>
@@ -16,6 +18,7 @@
 
 #include <atomic>
 #include <system_error>
+#include <vector>
 
 #include <unistd.h>
 
@@ -61,11 +64,29 @@ namespace f5 {
                     return write.async_write_some(std::forward<U>(u)...);
                 }
 
+                /// Write the count as a single byte. The byte comes from
+                /// static storage so that it stays alive for however long
+                /// the write takes, which matters for backends such as
+                /// io_uring that don't attempt the write straight away.
+                template<typename H>
+                void async_signal(unsigned char count, H handler) {
+                    static constexpr auto bytes = []() {
+                        std::array<unsigned char, 256> b{};
+                        for (std::size_t i{}; i < b.size(); ++i) { b[i] = i; }
+                        return b;
+                    }();
+                    boost::asio::async_write(
+                            *this, boost::asio::buffer(&bytes[count], 1),
+                            std::move(handler));
+                }
+
                 /// Close both ends of the pipe
                 void close() {
                     read.close();
                     write.close();
                 }
+                /// Returns true until the pipe is closed
+                bool is_open() const { return write.is_open(); }
             };
 
 
@@ -92,17 +113,14 @@ namespace f5 {
                     while (count) {
                         unsigned char c = std::min(count, uint64_t{255});
                         count -= c;
-                        boost::asio::async_write(
-                                pp, boost::asio::buffer(&c, 1),
-                                [](auto error, auto bytes) {
-                                    if (error) {
-                                        throw std::system_error(
-                                                error.value(),
-                                                std::generic_category(),
-                                                std::string("Bytes ")
-                                                        + std::to_string(bytes));
-                                    }
-                                });
+                        pp.async_signal(c, [](auto error, auto bytes) {
+                            if (error) {
+                                throw std::system_error(
+                                        error.value(), std::generic_category(),
+                                        std::string("Bytes ")
+                                                + std::to_string(bytes));
+                            }
+                        });
                     }
                 }
                 /// Return how much to consume. Yields until there is
@@ -116,9 +134,24 @@ namespace f5 {
                     }
                     return c;
                 }
+                /// Start reading how much to consume without yielding.
+                /// The count is read into `c`, which must stay alive until
+                /// the handler has been called with the error and count.
+                template<typename H>
+                void async_consume(unsigned char &c, H handler) {
+                    boost::asio::async_read(
+                            pp, boost::asio::buffer(&c, 1),
+                            boost::asio::transfer_exactly(1),
+                            [&c, handler = std::move(handler)](
+                                    auto error, auto) mutable {
+                                handler(error, c);
+                            });
+                }
 
                 /// Close the throttle
                 void close() { pp.close(); }
+                /// Returns true until the throttle is closed
+                bool is_open() const { return pp.is_open(); }
             };
 
 
@@ -202,11 +235,8 @@ namespace f5 {
                     void done(E efn) {
                         if (!completed) {
                             completed = true;
-                            unsigned char count = 1;
-                            boost::asio::async_write(
-                                    limit.pp,
-                                    boost::asio::buffer(&count, sizeof(count)),
-                                    [efn](auto error, auto bytes) {
+                            limit.pp.async_signal(
+                                    1, [efn](auto error, auto bytes) {
                                         if (error || bytes != sizeof(uint64_t))
                                             efn(error, bytes);
                                     });
@@ -217,14 +247,53 @@ namespace f5 {
 
                 /// Add another outstanding job and return it
                 std::unique_ptr<job> next_job(boost::asio::yield_context yield) {
+                    /// The count is only increased if it hasn't changed
+                    /// since we checked it against the limit, otherwise
+                    /// concurrent producers could overshoot the limit
+                    auto outstanding = m_outstanding.load();
                     while (true) {
                         const auto limit = m_limit.load();
-                        if (not limit || m_outstanding.load() < limit) break;
-                        wait(yield);
+                        if (limit && outstanding >= limit) {
+                            wait(yield);
+                            outstanding = m_outstanding.load();
+                        } else if (m_outstanding.compare_exchange_weak(
+                                           outstanding, outstanding + 1)) {
+                            break;
+                        }
                     }
-                    ++m_outstanding;
                     return std::unique_ptr<job>(new job(*this));
                 }
+                /// Add up to `count` outstanding jobs in one operation. Yields
+                /// until at least one job can be started and then returns
+                /// as many of the requested jobs as the limit allows.
+                std::vector<std::unique_ptr<job>> next_jobs(
+                        std::size_t count, boost::asio::yield_context yield) {
+                    std::vector<std::unique_ptr<job>> jobs;
+                    if (not count) return jobs;
+                    uint64_t available{};
+                    auto outstanding = m_outstanding.load();
+                    while (true) {
+                        const auto limit = m_limit.load();
+                        if (limit && outstanding >= limit) {
+                            wait(yield);
+                            outstanding = m_outstanding.load();
+                            continue;
+                        }
+                        available = limit ? std::min(
+                                            uint64_t(count),
+                                            limit - outstanding)
+                                          : uint64_t(count);
+                        if (m_outstanding.compare_exchange_weak(
+                                    outstanding, outstanding + available)) {
+                            break;
+                        }
+                    }
+                    jobs.reserve(available);
+                    while (jobs.size() < available) {
+                        jobs.emplace_back(new job(*this));
+                    }
+                    return jobs;
+                }
 
                 /// Close it
                 void close() { pp.close(); }
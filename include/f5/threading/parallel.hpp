@@ -0,0 +1,227 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/reactor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        namespace detail {
+
+
+            /// Shares out the indexes `[0, size)` in chunks. Each chunk is
+            /// a fraction of what is left, so chunks start large and get
+            /// smaller towards the end where they balance out the work.
+            class parallel_run {
+                const std::size_t size;
+                /// The number of threads that may be taking chunks
+                const std::size_t participants;
+                /// The start of the next chunk
+                std::atomic<std::size_t> next{};
+                /// The number of indexes that have been dealt with
+                std::atomic<std::size_t> finished{};
+                std::atomic<bool> failed{false};
+                std::mutex exclusive;
+                std::condition_variable all_done;
+                std::exception_ptr error;
+
+                /// Record that the indexes have been dealt with
+                void complete(std::size_t count) {
+                    if (finished.fetch_add(count) + count == size) {
+                        std::lock_guard<std::mutex> lock{exclusive};
+                        all_done.notify_all();
+                    }
+                }
+                /// Claim the next chunk. Returns false once there are no
+                /// more chunks to run.
+                bool claim(std::size_t &begin, std::size_t &end) {
+                    auto start = next.load();
+                    while (start < size) {
+                        if (failed) {
+                            /// Nothing else is run after an exception
+                            const auto rest = next.exchange(size);
+                            if (rest < size) { complete(size - rest); }
+                            return false;
+                        }
+                        const auto chunk = std::max(
+                                std::size_t{1},
+                                (size - start) / (2 * participants));
+                        if (next.compare_exchange_weak(start, start + chunk)) {
+                            begin = start;
+                            end = start + chunk;
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+              public:
+                parallel_run(std::size_t s, std::size_t p)
+                : size{s}, participants{p} {}
+
+                /// Run chunks until there are none left
+                template<typename F>
+                void work(F &body) {
+                    std::size_t begin, end;
+                    while (claim(begin, end)) {
+                        try {
+                            body(begin, end);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock{exclusive};
+                            if (not error) { error = std::current_exception(); }
+                            failed = true;
+                        }
+                        complete(end - begin);
+                    }
+                }
+                /// Block until every chunk has been dealt with and rethrow
+                /// the first exception, if there was one
+                void wait() {
+                    std::unique_lock<std::mutex> lock{exclusive};
+                    all_done.wait(lock, [this]() { return finished == size; });
+                    if (error) { std::rethrow_exception(error); }
+                }
+            };
+
+
+            /// Run the body over chunks of `[0, size)` using the pool's
+            /// threads and the calling thread. The caller always takes
+            /// part and only ever waits for chunks that are running, so
+            /// this is safe to call from one of the pool's own threads,
+            /// and the work still gets done if the pool won't take the
+            /// helpers because it is being drained.
+            template<typename F>
+            void parallel_chunks(reactor_pool &pool, std::size_t size, F body) {
+                if (not size) { return; }
+                auto run =
+                        std::make_shared<parallel_run>(size, pool.size() + 1);
+                /// Helpers share ownership of the body, as one may only
+                /// start after this function has returned
+                auto shared = std::make_shared<F>(std::move(body));
+                const auto helpers = std::min(pool.size(), size - 1);
+                for (std::size_t h{}; h != helpers; ++h) {
+                    pool.post([run, shared]() { run->work(*shared); });
+                }
+                run->work(*shared);
+                run->wait();
+            }
+
+
+            /// Returns its argument, for `parallel_reduce` without a
+            /// transformation
+            struct identity {
+                template<typename T>
+                T &&operator()(T &&t) const {
+                    return std::forward<T>(t);
+                }
+            };
+
+
+        }
+
+
+        /// Call the function with each index in `[first, last)`, spread
+        /// across the threads of the pool. The calling thread takes part
+        /// and the function returns once every index is done. The first
+        /// exception thrown is rethrown, and indexes that hadn't started
+        /// by then are skipped.
+        template<typename F>
+        void parallel_for(
+                reactor_pool &pool, std::size_t first, std::size_t last, F fn) {
+            if (last <= first) { return; }
+            detail::parallel_chunks(
+                    pool, last - first, [first, &fn](auto begin, auto end) {
+                        for (auto index = begin; index != end; ++index) {
+                            fn(first + index);
+                        }
+                    });
+        }
+
+
+        /// Write the result of the function for each item in the input
+        /// range to the output. Both ranges need random access iterators.
+        /// Returns the end of the output.
+        template<typename I, typename O, typename F>
+        O parallel_transform(
+                reactor_pool &pool, I first, I last, O out, F fn) {
+            const auto size = std::distance(first, last);
+            detail::parallel_chunks(
+                    pool, size, [first, out, &fn](auto begin, auto end) {
+                        auto in = first + begin;
+                        auto o = out + begin;
+                        for (auto index = begin; index != end; ++index) {
+                            *o++ = fn(*in++);
+                        }
+                    });
+            return out + size;
+        }
+
+
+        /// Combine the items in the range, after passing each through the
+        /// transformation, using the reduction. The reduction must be
+        /// associative, but need not be commutative as the partial results
+        /// are combined in order. The range needs random access iterators.
+        template<typename I,
+                 typename T,
+                 typename R,
+                 typename F = detail::identity>
+        T parallel_reduce(
+                reactor_pool &pool,
+                I first,
+                I last,
+                T init,
+                R reduce,
+                F transform = {}) {
+            std::mutex exclusive;
+            /// The partial result for each chunk and where it started
+            std::vector<std::pair<std::size_t, T>> partials;
+            detail::parallel_chunks(
+                    pool, std::distance(first, last),
+                    [&, first](auto begin, auto end) {
+                        auto in = first + begin;
+                        T partial = transform(*in++);
+                        for (auto index = begin + 1; index != end; ++index) {
+                            partial = reduce(
+                                    std::move(partial), transform(*in++));
+                        }
+                        std::lock_guard<std::mutex> lock{exclusive};
+                        partials.emplace_back(begin, std::move(partial));
+                    });
+            std::sort(
+                    partials.begin(), partials.end(),
+                    [](const auto &l, const auto &r) {
+                        return l.first < r.first;
+                    });
+            for (auto &p : partials) {
+                init = reduce(std::move(init), std::move(p.second));
+            }
+            return init;
+        }
+
+
+    }
+
+
+}
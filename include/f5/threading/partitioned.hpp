@@ -0,0 +1,168 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/limiters.hpp>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A producer/consumer queue where items with the same key are
+        /// processed one at a time and in order, whilst items with
+        /// different keys can be processed in parallel. Keys are hashed
+        /// on to a fixed number of lanes. A consumer holds the lane of
+        /// the item it is working on until it is done with it, and idle
+        /// consumers pick up whichever lane is next ready.
+        template<typename K, typename V, typename H = std::hash<K>>
+        class partitioned_queue {
+            /// The items for a group of keys
+            struct lane {
+                std::deque<V> items;
+                /// Set whilst a consumer is working on an item
+                bool held{false};
+                /// Set whilst the lane is in the ready list
+                bool queued{false};
+            };
+
+            /// Mutex that controls access to the lanes
+            std::mutex exclusive;
+            /// The lanes
+            std::vector<lane> lanes;
+            /// The lanes that have items and are not held, in the order
+            /// they became ready
+            std::deque<std::size_t> ready;
+            /// Communication between producer and consumer about how
+            /// many lanes are ready
+            threading::fd::unlimited signal;
+            /// Maps a key to its lane
+            H hash;
+
+            /// Add the lane to the ready list if it has work and isn't
+            /// held. Returns true if it was added. There must already be
+            /// a lock covering the lanes.
+            bool mark_ready(std::size_t index) {
+                auto &l = lanes[index];
+                if (l.held || l.queued || l.items.empty()) { return false; }
+                l.queued = true;
+                ready.push_back(index);
+                return true;
+            }
+            /// Let another consumer have the lane
+            void release(std::size_t index) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                lanes[index].held = false;
+                if (mark_ready(index)) {
+                    lock.unlock();
+                    signal.produced();
+                }
+            }
+
+          public:
+            /// An item that has been handed to a consumer. The lane it
+            /// came from is held until this is destroyed.
+            class item {
+                friend class partitioned_queue;
+                partitioned_queue *owner;
+                std::size_t index;
+                V v;
+
+                item(partitioned_queue &q, std::size_t i, V &&iv)
+                : owner{&q}, index{i}, v{std::move(iv)} {}
+
+              public:
+                item(item &&i)
+                : owner{std::exchange(i.owner, nullptr)},
+                  index{i.index},
+                  v{std::move(i.v)} {}
+                item &operator=(item &&) = delete;
+                /// Release the lane
+                ~item() { done(); }
+
+                /// The item
+                V &value() { return v; }
+                const V &value() const { return v; }
+                /// The lane the item came from
+                std::size_t lane() const { return index; }
+
+                /// Release the lane so that the next item with the same
+                /// key can be handed out, if not already done
+                void done() {
+                    if (owner) {
+                        std::exchange(owner, nullptr)->release(index);
+                    }
+                }
+            };
+
+            /// Construct for the specified IO service and number of lanes
+            partitioned_queue(
+                    boost::asio::io_service &ios,
+                    std::size_t lane_count,
+                    H h = H())
+            : lanes(lane_count), signal{ios}, hash{std::move(h)} {}
+
+            /// The number of lanes
+            std::size_t size() const { return lanes.size(); }
+
+            /// Produce an item to be consumed after any other items that
+            /// share its lane
+            void produce(const K &key, V v) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                const auto index = hash(key) % lanes.size();
+                lanes[index].items.push_back(std::move(v));
+                if (mark_ready(index)) {
+                    lock.unlock();
+                    signal.produced();
+                }
+            }
+
+            /// Return an item if one is available
+            std::optional<item> consume() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                if (ready.empty()) { return {}; }
+                const auto index = ready.front();
+                ready.pop_front();
+                auto &l = lanes[index];
+                l.queued = false;
+                l.held = true;
+                auto v = std::move(l.items.front());
+                l.items.pop_front();
+                return item{*this, index, std::move(v)};
+            }
+            /// Consume an item, block the coroutine until one becomes
+            /// available.
+            item consume(boost::asio::yield_context yield) {
+                while (true) {
+                    /// Another consumer may have taken the lane that was
+                    /// signalled, in which case we wait for the next one
+                    if (auto i = consume(); i) { return std::move(*i); }
+                    signal.consume(yield);
+                }
+            }
+
+            /// Close the queue
+            void close() { signal.close(); }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,169 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/queue.hpp>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// Storage for a queue that has a fixed number of priority lanes.
+        /// Items are pairs of a lane number and a value, where lane zero
+        /// has the highest priority. Items in the same lane are FIFO.
+        ///
+        /// When aging is turned on a lane that has been passed over that
+        /// many times whilst it had items waiting is served next, so that
+        /// low priority work is never starved.
+        template<typename T, std::size_t N = 4>
+        class priority_lanes {
+          public:
+            /// The lane the item goes in together with the item
+            using value_type = std::pair<std::size_t, T>;
+
+          private:
+            /// The items in each lane
+            std::array<std::deque<value_type>, N> lanes;
+            /// How many times each lane has been passed over
+            std::array<std::size_t, N> passed{};
+            /// How many times a lane can be passed over, zero for never
+            std::size_t aging;
+            /// The total number of items
+            std::size_t count{};
+
+            /// The lane the next item comes from
+            std::size_t selected() const {
+                std::size_t first = N;
+                for (std::size_t lane{}; lane < N; ++lane) {
+                    if (lanes[lane].empty()) { continue; }
+                    if (aging && passed[lane] >= aging) { return lane; }
+                    if (first == N) { first = lane; }
+                }
+                return first;
+            }
+
+          public:
+            /// Construct with optional aging
+            explicit priority_lanes(std::size_t a = 0) : aging{a} {}
+
+            /// Add an item to the back of its lane. Lane numbers past the
+            /// last lane go in the last lane.
+            void push_back(value_type v) {
+                const auto lane = std::min(v.first, N - 1);
+                lanes[lane].push_back(std::move(v));
+                ++count;
+            }
+            /// The next item to be consumed
+            value_type &front() { return lanes[selected()].front(); }
+            /// Remove the next item to be consumed
+            void pop_front() {
+                const auto lane = selected();
+                lanes[lane].pop_front();
+                --count;
+                passed[lane] = 0;
+                for (auto lower = lane + 1; lower < N; ++lower) {
+                    if (not lanes[lower].empty()) { ++passed[lower]; }
+                }
+            }
+            /// The total number of items
+            std::size_t size() const { return count; }
+        };
+
+
+        /// Storage for a queue that orders its items by a comparator. The
+        /// item that compares highest is consumed first and items that
+        /// compare equal are FIFO.
+        template<typename T, typename C = std::less<T>>
+        class priority_heap {
+          public:
+            using value_type = T;
+
+          private:
+            /// An item along with the order it was added in
+            struct entry {
+                uint64_t sequence;
+                T value;
+            };
+            /// The items, kept as a heap
+            std::vector<entry> items;
+            /// Used to keep items that compare equal in order
+            uint64_t added{};
+            /// Set when the next item has been moved to the back of the
+            /// vector, outside of the heap, so it can be taken from there
+            bool staged{false};
+            /// Orders the items
+            C compare;
+
+            /// Orders the heap entries, using the sequence to tie break
+            auto ordering() {
+                return [this](const entry &l, const entry &r) {
+                    if (compare(l.value, r.value)) { return true; }
+                    if (compare(r.value, l.value)) { return false; }
+                    return l.sequence > r.sequence;
+                };
+            }
+
+            /// Move the next item out of the heap to the back of the vector
+            void stage() {
+                if (not staged) {
+                    std::pop_heap(items.begin(), items.end(), ordering());
+                    staged = true;
+                }
+            }
+
+          public:
+            /// Construct with the comparator
+            explicit priority_heap(C c = C()) : compare{std::move(c)} {}
+
+            /// Add an item
+            void push_back(T t) {
+                if (staged) {
+                    std::push_heap(items.begin(), items.end(), ordering());
+                    staged = false;
+                }
+                items.push_back(entry{added++, std::move(t)});
+                std::push_heap(items.begin(), items.end(), ordering());
+            }
+            /// The next item to be consumed
+            T &front() {
+                stage();
+                return items.back().value;
+            }
+            /// Remove the next item to be consumed
+            void pop_front() {
+                stage();
+                items.pop_back();
+                staged = false;
+            }
+            /// The number of items
+            std::size_t size() const { return items.size(); }
+        };
+
+
+        /// A queue with a fixed number of priority lanes. Items are
+        /// produced and consumed as a pair of the lane and the value.
+        template<typename T, std::size_t N = 4>
+        using priority_queue =
+                queue<std::pair<std::size_t, T>, priority_lanes<T, N>>;
+
+
+    }
+
+
+}
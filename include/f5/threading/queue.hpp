@@ -14,6 +14,7 @@
 #include <deque>
 #include <optional>
 #include <mutex>
+#include <type_traits>
 
 
 namespace f5 {
@@ -29,6 +30,9 @@ namespace f5 {
         /// similar concept see channel.
         template<typename T, typename S = std::deque<T>>
         class queue {
+            template<typename>
+            friend class select;
+
             /// Mutex that controls access to the queue items
             std::mutex exclusive;
             /// The current queue content
@@ -61,6 +65,24 @@ namespace f5 {
                 lock.unlock();
                 signal.produced();
             }
+            /// Produce all of the items in the range under a single lock.
+            /// The consumers are signalled once for the whole batch.
+            /// Items are moved out of the range if it is an rvalue.
+            template<typename R>
+            void produce_many(R &&range) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                std::size_t count{};
+                for (auto &item : range) {
+                    if constexpr (std::is_rvalue_reference_v<R &&>) {
+                        items.push_back(std::move(item));
+                    } else {
+                        items.push_back(item);
+                    }
+                    ++count;
+                }
+                lock.unlock();
+                if (count) { signal.produced(count); }
+            }
 
             /// Consume an item, block the coroutine until one becomes
             /// available.
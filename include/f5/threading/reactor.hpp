@@ -9,10 +9,24 @@
 #pragma once
 
 
+#include <f5/threading/affinity.hpp>
+#include <f5/threading/instrumentation.hpp>
+
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/coroutine/exceptions.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 
 namespace f5 {
@@ -21,16 +35,278 @@ namespace f5 {
     namespace boost_asio {
 
 
+        namespace detail {
+            /// Run the io_service on the current thread until it stops or
+            /// the exception handler says not to carry on. The runner is
+            /// what actually runs the io_service.
+            template<typename R, typename F>
+            void run_reactor(R runner, F exception_handler) {
+                bool again = false;
+                do {
+                    try {
+                        again = false;
+                        runner();
+                    } catch (boost::coroutines::detail::forced_unwind &) {
+                        throw;
+                    } catch (...) { again = exception_handler(); }
+                } while (again);
+            }
+
+            /// Where a thread runs
+            struct seat {
+                /// The CPUs the thread is pinned to, if any
+                std::vector<int> cpus;
+                /// The NUMA node those CPUs are in
+                std::optional<std::size_t> node;
+            };
+            /// Work out where the threads numbered from `first` run, as
+            /// the placement describes
+            inline std::vector<seat> place(
+                    std::size_t first,
+                    std::size_t count,
+                    const placement &where) {
+                std::vector<seat> seats(count);
+                if (where.how == placement::policy::none) { return seats; }
+                const topology machine;
+                for (std::size_t index{}; index != count; ++index) {
+                    auto &s = seats[index];
+                    s.cpus = where.cpus_for(first + index, machine);
+                    if (not s.cpus.empty()) {
+                        s.node = machine.node_of(s.cpus.front());
+                    }
+                }
+                return seats;
+            }
+
+            /// Start a thread that pins itself to the CPUs before it calls
+            /// the function, so nothing runs on it before it is in place.
+            /// Returns once the thread has been pinned, or throws if it
+            /// couldn't be.
+            template<typename F>
+            std::thread launch(std::vector<int> cpus, F fn) {
+                std::promise<void> pinned;
+                auto ready = pinned.get_future();
+                std::thread thread{[cpus = std::move(cpus),
+                                    pinned = std::move(pinned),
+                                    fn = std::move(fn)]() mutable {
+                    try {
+                        pin(cpus);
+                    } catch (...) {
+                        pinned.set_exception(std::current_exception());
+                        return;
+                    }
+                    pinned.set_value();
+                    fn();
+                }};
+                try {
+                    ready.get();
+                } catch (...) {
+                    thread.join();
+                    throw;
+                }
+                return thread;
+            }
+        }
+
+
         /// A pool of the requested number of threads for use in servicing
-        /// an io_service.
+        /// an io_service. Threads can be added and retired whilst the pool
+        /// is running, either explicitly or automatically based on how
+        /// long handlers wait in the io_service before they run.
         class reactor_pool final {
+            /// A thread in the pool
+            struct member {
+                std::thread thread;
+                /// The NUMA node the thread has been placed on
+                std::optional<std::size_t> node;
+                /// Set once the thread has stopped and can be joined
+                std::atomic<bool> finished{false};
+                /// How long the thread polls for handlers before it blocks.
+                /// Zero means it always blocks.
+                std::atomic<std::chrono::nanoseconds> spin_budget{};
+                /// Time spent polling and time spent running handlers
+                /// whilst spinning, in nanoseconds
+                std::atomic<uint64_t> spinning{}, working{};
+                /// The number of handlers run whilst spinning
+                std::atomic<uint64_t> handlers{};
+            };
             /// The Boost ASIO IO service that is run by this pool
             boost::asio::io_service ios;
-            /// The threads in the pool
-            std::vector<std::thread> threads;
             /// Work instance used to stop the threads from terminating
             /// until we want them to.
             std::unique_ptr<boost::asio::io_service::work> work;
+            std::function<bool()> exception_handler;
+            placement where;
+            /// Mutex that controls changes to the threads
+            mutable std::mutex resize;
+            /// The threads in the pool. A thread keeps its place after it
+            /// has stopped so that the others keep their numbers, and the
+            /// place is only reused by a thread started later on.
+            std::vector<std::unique_ptr<member>> threads;
+            /// The number of threads that are due to retire. Only changed
+            /// whilst there is a lock covering the threads.
+            std::atomic<std::size_t> retiring{};
+            /// The number of threads started, used for placement
+            std::size_t started{};
+            /// Used to probe the queue delay when sizing automatically
+            std::unique_ptr<boost::asio::steady_timer> probe;
+            /// Changes when automatic sizing is restarted so that an old
+            /// probe stops
+            uint64_t sizing{};
+            /// Only created if instrumentation is turned on
+            std::unique_ptr<instrumentation> monitor;
+            std::atomic<instrumentation *> instrumented{};
+            /// Set once the pool stops accepting new work
+            std::atomic<bool> draining{false};
+            /// Signalled whenever a thread stops
+            std::condition_variable exited;
+
+            /// Start more threads. There must already be a lock covering
+            /// the threads.
+            void start(std::size_t count) {
+                auto slot = threads.begin();
+                for (auto &seat : detail::place(started, count, where)) {
+                    ++started;
+                    slot = std::find_if(slot, threads.end(), [](auto &m) {
+                        return not m->thread.joinable();
+                    });
+                    auto added = std::make_unique<member>();
+                    added->node = seat.node;
+                    added->thread = detail::launch(
+                            std::move(seat.cpus),
+                            [this, &m = *added]() { run(m); });
+                    if (slot == threads.end()) {
+                        threads.push_back(std::move(added));
+                        slot = threads.end();
+                    } else {
+                        *slot++ = std::move(added);
+                    }
+                }
+            }
+            /// The body of each of the pool's threads
+            void run(member &m) {
+                detail::run_reactor(
+                        [this, &m]() { serve(m); }, exception_handler);
+                /// A retired thread has already been marked as finished and
+                /// may be being joined
+                if (m.finished) { return; }
+                std::lock_guard<std::mutex> lock{resize};
+                m.finished = true;
+                exited.notify_all();
+            }
+            /// Called by a pool thread between handlers. If threads are
+            /// due to retire then this one takes one of the places and is
+            /// marked as finished. Returns true if the thread should stop.
+            bool retired(member &m) {
+                if (not retiring.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                std::lock_guard<std::mutex> lock{resize};
+                if (not retiring) { return false; }
+                --retiring;
+                m.finished = true;
+                exited.notify_all();
+                return true;
+            }
+            /// Call the runner, which runs at most one handler, timing the
+            /// handler if instrumentation is turned on
+            template<typename R>
+            std::size_t timed(R runner) {
+                if (auto i = instrumented.load(); i) { return i->time(runner); }
+                return runner();
+            }
+            /// Run handlers on the thread until the io_service stops. When
+            /// the thread has a spin budget it polls for handlers until it
+            /// has gone that long without finding one before it blocks.
+            void serve(member &m) {
+                using clock = std::chrono::steady_clock;
+                while (true) {
+                    const auto budget =
+                            m.spin_budget.load(std::memory_order_relaxed);
+                    if (budget.count() > 0) {
+                        auto idle_since = clock::now();
+                        while (true) {
+                            const auto before = clock::now();
+                            const auto ran =
+                                    timed([this]() { return ios.poll_one(); });
+                            const auto after = clock::now();
+                            const uint64_t took =
+                                    std::chrono::duration_cast<
+                                            std::chrono::nanoseconds>(
+                                            after - before)
+                                            .count();
+                            if (ran) {
+                                m.working += took;
+                                ++m.handlers;
+                                idle_since = after;
+                                if (retired(m)) { return; }
+                            } else if (ios.stopped()) {
+                                return;
+                            } else {
+                                m.spinning += took;
+                                if (after - idle_since >= budget) { break; }
+                            }
+                        }
+                    }
+                    if (auto i = instrumented.load(); i) {
+                        /// Time the handlers that are already waiting.
+                        /// Once there are none, block until there is more
+                        /// work like any other thread.
+                        if (i->time([this]() { return ios.poll_one(); })) {
+                            if (retired(m)) { return; }
+                            continue;
+                        }
+                    }
+                    if (not ios.run_one() || retired(m)) { return; }
+                }
+            }
+            /// Let the threads finish once they run out of work and stop
+            /// the timers that the pool uses itself. There must already be
+            /// a lock covering the threads.
+            void stop_accepting() {
+                draining = true;
+                if (work) {
+                    work.reset();
+                    if (probe) { probe->cancel(); }
+                    if (monitor) { monitor->close(); }
+                }
+            }
+            /// Join the threads that have stopped. They keep their places.
+            /// There must already be a lock covering the threads.
+            void reap() {
+                for (auto &m : threads) {
+                    if (m->finished && m->thread.joinable()) {
+                        m->thread.join();
+                    }
+                }
+            }
+            /// Measure how long a handler waits to run and resize the pool
+            /// based on it
+            void measure(
+                    std::size_t minimum,
+                    std::size_t maximum,
+                    std::chrono::microseconds target,
+                    std::chrono::microseconds interval) {
+                probe->expires_after(interval);
+                probe->async_wait([=, generation = sizing](auto error) {
+                    if (error) { return; }
+                    const auto posted = std::chrono::steady_clock::now();
+                    boost::asio::post(ios, [=]() {
+                        const auto delay =
+                                std::chrono::steady_clock::now() - posted;
+                        const auto count = size();
+                        if (delay > target && count < maximum) {
+                            grow(1);
+                        } else if (delay < target / 4 && count > minimum) {
+                            shrink(1);
+                        }
+                        std::lock_guard<std::mutex> lock{resize};
+                        if (work && generation == sizing) {
+                            measure(minimum, maximum, target, interval);
+                        }
+                    });
+                });
+            }
 
           public:
             /// Default construct a reactor pool with thread count matching
@@ -42,51 +318,327 @@ namespace f5 {
             /// the passed in exception handler. The handler returns true
             /// if it wishes this thread to continue to handle jobs. If it
             /// returns false then the thread exits, but it won't be joined
-            /// until the pool itself passes out of scope.
+            /// until the pool is resized or passes out of scope.
+            ///
+            /// The placement says which CPUs the threads are pinned to.
             template<typename F>
             explicit reactor_pool(
-                    F exception_handler,
+                    F handler,
                     std::size_t thread_count =
-                            std::thread::hardware_concurrency())
-            : work(std::make_unique<boost::asio::io_service::work>(ios)) {
-                for (auto t = 0u; t != thread_count; ++t) {
-                    threads.emplace_back([this, exception_handler]() {
-                        bool again = false;
-                        do {
-                            try {
-                                again = false;
-                                ios.run();
-                            } catch (
-                                    boost::coroutines::detail::forced_unwind &) {
-                                throw;
-                            } catch (...) { again = exception_handler(); }
-                        } while (again);
-                    });
+                            std::thread::hardware_concurrency(),
+                    const placement &p = {})
+            : work(std::make_unique<boost::asio::io_service::work>(ios)),
+              exception_handler{std::move(handler)},
+              where{p} {
+                std::lock_guard<std::mutex> lock{resize};
+                try {
+                    start(thread_count);
+                } catch (...) {
+                    work.reset();
+                    ios.stop();
+                    for (auto &m : threads) {
+                        if (m->thread.joinable()) { m->thread.join(); }
+                    }
+                    throw;
                 }
             }
 
             /// Stop all work and join all threads
             void close() {
-                if (work) {
-                    work.reset();
-                    ios.stop();
-                    for (auto &t : threads) t.join();
+                std::unique_lock<std::mutex> lock{resize};
+                stop_accepting();
+                ios.stop();
+                auto stopping = std::move(threads);
+                threads.clear();
+                lock.unlock();
+                for (auto &m : stopping) {
+                    if (m->thread.joinable()) { m->thread.join(); }
                 }
             }
             ~reactor_pool() { close(); }
 
+            /// Stop accepting new work through `post` and wait for the
+            /// work that is already queued, including coroutines, to
+            /// finish before joining the threads. Anything that hasn't
+            /// finished by the deadline is abandoned as it is by `close`.
+            /// Returns true if all of the work finished in time.
+            ///
+            /// Any coroutine waiting on something that will never happen,
+            /// like a queue that nothing produces to, keeps the pool busy
+            /// until the deadline.
+            template<typename Clock, typename Duration>
+            bool drain(std::chrono::time_point<Clock, Duration> deadline) {
+                std::unique_lock<std::mutex> lock{resize};
+                stop_accepting();
+                const bool drained =
+                        exited.wait_until(lock, deadline, [this]() {
+                            return std::all_of(
+                                    threads.begin(), threads.end(),
+                                    [](auto &m) { return m->finished.load(); });
+                        });
+                lock.unlock();
+                close();
+                return drained;
+            }
+            /// Drain the pool, waiting no longer than the timeout
+            template<typename Rep, typename Period>
+            bool drain(std::chrono::duration<Rep, Period> timeout) {
+                return drain(std::chrono::steady_clock::now() + timeout);
+            }
+
             /// Make non-copyable and non assignable
             reactor_pool(const reactor_pool &) = delete;
             reactor_pool &operator=(const reactor_pool &) = delete;
 
-            /// Return the number of threads servicing the pool
-            std::size_t size() const { return threads.size(); }
+            /// Add threads to the pool
+            void grow(std::size_t count) {
+                std::lock_guard<std::mutex> lock{resize};
+                if (not work) { return; }
+                reap();
+                start(count);
+            }
+            /// Retire threads from the pool. Each thread retires once it
+            /// finishes the handler it is running, so coroutines that are
+            /// part way through carry on in the remaining threads. At
+            /// least one thread is always kept. Only the pool's own threads
+            /// retire, so other threads running the io_service are never
+            /// affected. The threads that are left keep their numbers.
+            void shrink(std::size_t count) {
+                std::lock_guard<std::mutex> lock{resize};
+                if (not work) { return; }
+                reap();
+                const auto active = static_cast<std::size_t>(std::count_if(
+                        threads.begin(), threads.end(),
+                        [](auto &m) { return not m->finished; }));
+                const auto left = active - std::min(active, retiring.load());
+                count = std::min(count, left ? left - 1 : 0);
+                retiring += count;
+                /// Wake threads that are waiting for work so that they
+                /// notice
+                for (auto t = 0u; t != count; ++t) {
+                    boost::asio::post(ios, []() {});
+                }
+            }
+            /// Resize the pool automatically between the minimum and
+            /// maximum thread counts. Every interval the time a handler
+            /// waits before it runs is measured. A thread is added when
+            /// this is over the target and one is retired when it is
+            /// well under.
+            void autosize(
+                    std::size_t minimum,
+                    std::size_t maximum,
+                    std::chrono::microseconds target,
+                    std::chrono::microseconds interval =
+                            std::chrono::milliseconds{100}) {
+                std::lock_guard<std::mutex> lock{resize};
+                if (not work) { return; }
+                ++sizing;
+                if (probe) {
+                    probe->cancel();
+                } else {
+                    probe = std::make_unique<boost::asio::steady_timer>(ios);
+                }
+                measure(std::max(minimum, std::size_t{1}), maximum, target,
+                        interval);
+            }
+
+            /// Return the number of threads servicing the pool, not
+            /// counting those that are due to retire
+            std::size_t size() const {
+                std::lock_guard<std::mutex> lock{resize};
+                std::size_t active{};
+                for (auto &m : threads) {
+                    if (not m->finished) { ++active; }
+                }
+                return active - std::min(active, retiring.load());
+            }
+            /// Return the NUMA node the thread was placed on, if it was
+            /// pinned. Throws `std::out_of_range` if the pool has no such
+            /// thread.
+            std::optional<std::size_t> node_of(std::size_t thread) const {
+                std::lock_guard<std::mutex> lock{resize};
+                return threads.at(thread)->node;
+            }
+
+            /// Make the thread poll for handlers rather than sleep until it
+            /// has gone for the budget without finding one. This cuts the
+            /// latency of waking the thread up at the cost of a busy
+            /// core. A budget of zero turns spinning off. The thread picks
+            /// up the change the next time it runs a handler. Throws
+            /// `std::out_of_range` if the pool has no such thread.
+            void spin(std::size_t thread, std::chrono::nanoseconds budget) {
+                std::lock_guard<std::mutex> lock{resize};
+                threads.at(thread)->spin_budget = budget;
+            }
+            /// How a spinning thread has spent its time
+            struct spin_statistics {
+                /// Time spent polling without finding a handler
+                std::chrono::nanoseconds spinning;
+                /// Time spent running handlers found by polling
+                std::chrono::nanoseconds working;
+                /// The number of handlers found by polling
+                uint64_t handlers;
+            };
+            /// Return how the thread has spent its time whilst spinning.
+            /// Throws `std::out_of_range` if the pool has no such thread.
+            spin_statistics spin_time(std::size_t thread) const {
+                std::lock_guard<std::mutex> lock{resize};
+                const auto &m = *threads.at(thread);
+                return {std::chrono::nanoseconds(m.spinning.load()),
+                        std::chrono::nanoseconds(m.working.load()),
+                        m.handlers.load()};
+            }
+
+            /// Turn on instrumentation for the pool. Once turned on it
+            /// stays on until the pool is closed. Calling this again
+            /// returns the existing instrumentation. A thread that is
+            /// waiting for work starts timing after the next handler it
+            /// runs.
+            instrumentation &instrument(instrumentation_options options = {}) {
+                std::lock_guard<std::mutex> lock{resize};
+                if (not monitor) {
+                    monitor = std::make_unique<instrumentation>(
+                            ios, std::move(options));
+                    instrumented = monitor.get();
+                    /// Wake the threads that are waiting for work so that
+                    /// they start timing handlers
+                    for (auto t = threads.size(); t; --t) {
+                        boost::asio::post(ios, []() {});
+                    }
+                }
+                return *monitor;
+            }
+            /// Return the instrumentation, or nullptr if it is not on
+            instrumentation *instruments() const { return instrumented; }
+
+            /// Post a function to be run by the pool. If instrumentation
+            /// is turned on the wait is measured and the function's type
+            /// is used as its label. Returns
+            /// false, without posting, once the pool is being drained or
+            /// has been closed.
+            template<typename F>
+            bool post(F &&f) {
+                if (draining) { return false; }
+                if (auto i = instrumented.load(); i) {
+                    boost::asio::post(ios, i->wrap(std::forward<F>(f)));
+                } else {
+                    boost::asio::post(ios, std::forward<F>(f));
+                }
+                return true;
+            }
 
             /// Return the contained io_service instance
             boost::asio::io_service &get_io_service() { return ios; }
         };
 
 
+        /// A pool of threads where each thread runs its own io_service.
+        /// Handlers posted to a shard always run on that shard's thread,
+        /// so the shards don't contend on a shared handler queue and
+        /// their data stays in one core's cache. Work is spread across
+        /// the shards by the caller, either explicitly or round-robin.
+        class sharded_reactor_pool final {
+            /// A single io_service and the thread that runs it
+            struct shard {
+                /// Each io_service is only ever run by one thread
+                boost::asio::io_service ios{1};
+                std::unique_ptr<boost::asio::io_service::work> work{
+                        std::make_unique<boost::asio::io_service::work>(ios)};
+                std::thread thread;
+            };
+            /// The shards in the pool
+            std::vector<std::unique_ptr<shard>> shards;
+            /// Used to choose the shard for round-robin
+            std::atomic<std::size_t> next{};
+            /// The NUMA node each shard's thread has been placed on
+            std::vector<std::optional<std::size_t>> nodes;
+
+          public:
+            /// Default construct a pool with a shard per hardware thread
+            /// that will terminate threads if exceptions leak
+            sharded_reactor_pool()
+            : sharded_reactor_pool([]() { return false; }) {}
+
+            /// Construct a pool with the requested number of shards using
+            /// the passed in exception handler. The handler and placement
+            /// work the same as the ones for `reactor_pool`.
+            template<typename F>
+            explicit sharded_reactor_pool(
+                    F exception_handler,
+                    std::size_t shard_count =
+                            std::thread::hardware_concurrency(),
+                    const placement &where = {}) {
+                shard_count = std::max(shard_count, std::size_t{1});
+                for (auto s = 0u; s != shard_count; ++s) {
+                    shards.push_back(std::make_unique<shard>());
+                }
+                auto seats = detail::place(0, shards.size(), where);
+                try {
+                    for (std::size_t index{}; index != shards.size();
+                         ++index) {
+                        auto &s = *shards[index];
+                        nodes.push_back(seats[index].node);
+                        s.thread = detail::launch(
+                                std::move(seats[index].cpus),
+                                [&ios = s.ios, exception_handler]() {
+                                    detail::run_reactor(
+                                            [&ios]() { ios.run(); },
+                                            exception_handler);
+                                });
+                    }
+                } catch (...) {
+                    close();
+                    throw;
+                }
+            }
+
+            /// Stop all work and join all threads
+            void close() {
+                for (auto &s : shards) {
+                    if (s->work) {
+                        s->work.reset();
+                        s->ios.stop();
+                    }
+                }
+                for (auto &s : shards) {
+                    if (s->thread.joinable()) { s->thread.join(); }
+                }
+            }
+            ~sharded_reactor_pool() { close(); }
+
+            /// Make non-copyable and non assignable
+            sharded_reactor_pool(const sharded_reactor_pool &) = delete;
+            sharded_reactor_pool &
+                    operator=(const sharded_reactor_pool &) = delete;
+
+            /// Return the number of shards, which is also the number of
+            /// threads
+            std::size_t size() const { return shards.size(); }
+            /// Return the NUMA node the shard's thread was placed on, if it
+            /// was pinned
+            std::optional<std::size_t> node_of(std::size_t index) const {
+                return nodes[index % nodes.size()];
+            }
+
+            /// Return the io_service for the shard. Shard numbers wrap
+            /// around so that a hash can be used directly.
+            boost::asio::io_service &get_io_service(std::size_t index) {
+                return shards[index % shards.size()]->ios;
+            }
+            /// Return the io_service of each shard in turn
+            boost::asio::io_service &next_io_service() {
+                return get_io_service(next++);
+            }
+
+            /// Post the function to run on the shard. This can be called
+            /// from any thread, including the threads of other shards.
+            template<typename F>
+            void post(std::size_t index, F &&f) {
+                boost::asio::post(get_io_service(index), std::forward<F>(f));
+            }
+        };
+
+
     }
 
 
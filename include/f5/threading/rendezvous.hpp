@@ -0,0 +1,146 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/waiters.hpp>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <mutex>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A channel with no capacity. The producer waits until a
+        /// consumer has taken its value, which is moved straight out of
+        /// the producer's frame into the consumer's. Only one value is
+        /// on offer at any time, so further producers wait for the
+        /// single slot to become free. Waiting coroutines are kept in
+        /// lists on their own stacks and a hand-off wakes at most one
+        /// coroutine on each side, so it uses no file descriptors and
+        /// doesn't allocate. For a buffered version see channel.
+        template<typename V>
+        class rendezvous {
+            boost::asio::io_service &service;
+            /// Mutex that controls access to the slot and the waiters
+            std::mutex exclusive;
+            /// The value on offer. Points into the frame of the producer
+            /// that currently holds the slot
+            V *offered = nullptr;
+            /// Set by the consumer once it has moved the value out
+            bool taken = false;
+            bool closed = false;
+            /// Consumers waiting for a value to be offered
+            detail::waiters consumers;
+            /// The producer holding the slot, waiting for its value to be
+            /// taken
+            detail::waiters holder;
+            /// Producers waiting for the slot to become free
+            detail::waiters producers;
+
+            /// Throw if the rendezvous has been closed. There must
+            /// already be a lock covering the slot.
+            void check() const {
+                if (closed) {
+                    throw boost::system::system_error{
+                            boost::asio::error::operation_aborted};
+                }
+            }
+
+          public:
+            /// The type of item that is handed over
+            using value_type = V;
+
+            /// Construct for the specified IO service
+            rendezvous(boost::asio::io_service &ios) : service{ios} {}
+
+            /// Make non-copyable and non assignable
+            rendezvous(const rendezvous &) = delete;
+            rendezvous &operator=(const rendezvous &) = delete;
+
+            /// Return the IO service
+            boost::asio::io_service &get_io_service() { return service; }
+
+            /// Offer the value to a consumer. The coroutine yields until
+            /// a consumer has taken it.
+            void produce(V v, boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                while (offered) {
+                    check();
+                    producers.wait(lock, yield);
+                    lock.lock();
+                }
+                check();
+                offered = &v;
+                taken = false;
+                auto consumer = consumers.take_one();
+                lock.unlock();
+                consumer.resume();
+                lock.lock();
+                while (not taken) {
+                    if (closed) {
+                        /// The value lives in this frame so it must be
+                        /// withdrawn before the frame goes away
+                        offered = nullptr;
+                        check();
+                    }
+                    holder.wait(lock, yield);
+                    lock.lock();
+                }
+                offered = nullptr;
+                auto next = producers.take_one();
+                lock.unlock();
+                next.resume();
+            }
+
+            /// Yield until a producer offers a value and return it
+            V consume(boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                /// Another consumer may have got to the value before this
+                /// one was woken, in which case we wait for the next one.
+                while (not offered || taken) {
+                    check();
+                    consumers.wait(lock, yield);
+                    lock.lock();
+                }
+                V v{std::move(*offered)};
+                taken = true;
+                auto producer = holder.take();
+                lock.unlock();
+                producer.resume();
+                return v;
+            }
+
+            /// Close the rendezvous. Waiting producers and consumers
+            /// are woken with an error.
+            void close() {
+                std::unique_lock<std::mutex> lock{exclusive};
+                closed = true;
+                auto woken_consumers = consumers.take(),
+                     woken_holder = holder.take(),
+                     woken_producers = producers.take();
+                lock.unlock();
+                woken_consumers.resume();
+                woken_holder.resume();
+                woken_producers.resume();
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,210 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/channel.hpp>
+
+#include <utility>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        namespace detail {
+
+
+            /// Produce to a queue, which never needs to wait
+            template<typename T, typename S>
+            void produce_to(queue<T, S> &q, T v, boost::asio::yield_context) {
+                q.produce(std::move(v));
+            }
+            /// Produce to a channel, yielding if it is full
+            template<typename T>
+            void produce_to(
+                    channel<T> &c, T v, boost::asio::yield_context yield) {
+                c.produce(std::move(v), yield);
+            }
+
+
+        }
+
+
+        /// Restores the sequence of items that have been processed out of
+        /// order and releases them, in order, to a downstream queue or
+        /// channel. Sequence numbers are handed out by `next` and are
+        /// limited to a window, so the producer of the work yields if the
+        /// oldest item is holding up too many later ones. A ticket that
+        /// is destroyed without its item being inserted is skipped.
+        template<typename V, typename D = queue<V>>
+        class reorder {
+            /// An item waiting for the ones before it. There is no value
+            /// if the ticket was dropped.
+            struct slot {
+                std::unique_ptr<threading::fd::limiter::job> job;
+                std::optional<V> value;
+            };
+
+            /// The items that have arrived early, indexed by sequence
+            /// number modulo the window size
+            std::vector<std::optional<slot>> window;
+            /// Where the items are released to
+            D &downstream;
+            /// Bounds the number of sequence numbers in use
+            threading::fd::limiter throttle;
+            /// Mutex that controls access to the window
+            std::mutex exclusive;
+            /// The sequence number of the next item to release
+            uint64_t released{};
+            /// The next sequence number to hand out
+            uint64_t issued{};
+            /// Set whilst an insert is releasing items downstream
+            bool releasing{false};
+
+            /// Produce the items that are due downstream, passing over
+            /// those whose tickets were dropped. The lock must be held
+            /// and `releasing` set, and it is cleared again before this
+            /// returns.
+            void release(
+                    std::unique_lock<std::mutex> &lock,
+                    boost::asio::yield_context yield) {
+                try {
+                    for (auto *due = &window[released % window.size()]; *due;
+                         due = &window[released % window.size()]) {
+                        auto item = std::move(**due);
+                        due->reset();
+                        ++released;
+                        if (item.value) {
+                            lock.unlock();
+                            detail::produce_to(
+                                    downstream, std::move(*item.value),
+                                    yield);
+                            lock.lock();
+                        }
+                    }
+                } catch (...) {
+                    if (not lock.owns_lock()) { lock.lock(); }
+                    releasing = false;
+                    throw;
+                }
+                releasing = false;
+            }
+            /// Mark the sequence number as skipped. Its place in the
+            /// window is held until the items before it have been
+            /// released. If it was holding up items that have already
+            /// arrived then a coroutine is started to release them.
+            void skip(
+                    uint64_t seq,
+                    std::unique_ptr<threading::fd::limiter::job> job) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                window[seq % window.size()].emplace(slot{std::move(job), {}});
+                if (releasing || not window[released % window.size()]) {
+                    return;
+                }
+                releasing = true;
+                lock.unlock();
+                auto &ios = throttle.get_io_service();
+                boost::asio::spawn(ios, [this](auto yield) {
+                    std::unique_lock<std::mutex> lock{exclusive};
+                    try {
+                        release(lock, yield);
+                    } catch (boost::system::system_error &) {
+                        /// The downstream has been closed
+                    }
+                });
+            }
+
+          public:
+            /// Construct with a window of the specified size
+            reorder(boost::asio::io_service &ios, D &d, std::size_t size)
+            : window(size), downstream{d}, throttle{ios, size} {}
+
+            /// Return the size of the window
+            std::size_t size() const { return window.size(); }
+
+            /// A reserved place in the sequence. If it is destroyed
+            /// without being inserted then its sequence number is skipped.
+            class ticket {
+                friend class reorder;
+                reorder *owner;
+                uint64_t seq;
+                std::unique_ptr<threading::fd::limiter::job> job;
+
+                ticket(reorder *o,
+                       uint64_t s,
+                       std::unique_ptr<threading::fd::limiter::job> j)
+                : owner{o}, seq{s}, job{std::move(j)} {}
+
+                /// Skip the sequence number if it is still held
+                void abandon() {
+                    if (auto *o = std::exchange(owner, nullptr); o) {
+                        o->skip(seq, std::move(job));
+                    }
+                }
+
+              public:
+                ticket(ticket &&t)
+                : owner{std::exchange(t.owner, nullptr)},
+                  seq{t.seq},
+                  job{std::move(t.job)} {}
+                ticket &operator=(ticket &&t) {
+                    if (this != &t) {
+                        abandon();
+                        owner = std::exchange(t.owner, nullptr);
+                        seq = t.seq;
+                        job = std::move(t.job);
+                    }
+                    return *this;
+                }
+                ~ticket() { abandon(); }
+
+                /// The sequence number this ticket is for
+                uint64_t sequence() const { return seq; }
+            };
+
+            /// Return the next sequence number. The coroutine yields
+            /// whilst the window is full.
+            ticket next(boost::asio::yield_context yield) {
+                auto job = throttle.next_job(yield);
+                std::lock_guard<std::mutex> lock{exclusive};
+                return ticket{this, issued++, std::move(job)};
+            }
+
+            /// Insert the item for the ticket. If it is the next item due
+            /// then it, and any following ones that have already arrived,
+            /// are produced downstream. The place in the window is only
+            /// given up once the item has been produced, so a full
+            /// downstream channel also holds up `next`.
+            void insert(ticket t, V v, boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{exclusive};
+                t.owner = nullptr;
+                window[t.seq % window.size()].emplace(
+                        slot{std::move(t.job), std::move(v)});
+                /// Only one insert releases at a time so the items are
+                /// produced in order. Whoever is releasing will pick up
+                /// this item if it is due.
+                if (releasing) { return; }
+                releasing = true;
+                release(lock, yield);
+            }
+
+            /// Close the reorder buffer. Coroutines waiting for a ticket
+            /// are woken with an error.
+            void close() { throttle.close(); }
+        };
+
+
+    }
+
+
+}
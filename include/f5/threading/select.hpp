@@ -0,0 +1,201 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/channel.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// Consume from whichever of several queues and channels has an
+        /// item ready first. Each source has at most one read of its
+        /// signal outstanding on behalf of the select, and the sources
+        /// are checked in turn starting after the one that was last
+        /// served so that a busy source can't starve the others.
+        ///
+        /// A source that is also consumed from elsewhere may have one of
+        /// its wake ups held by the select until the select is next
+        /// used or is destroyed.
+        template<typename V>
+        class select {
+            /// A queue or channel being selected over
+            struct source {
+                /// Take an item without waiting, if one is available
+                std::function<std::optional<V>()> take;
+                /// The signal the source uses to wake its consumers
+                threading::fd::unlimited *signal;
+                /// Buffer for the outstanding signal read
+                unsigned char count{};
+                /// Set whilst a signal read is outstanding
+                bool armed{false};
+                /// Set once the signal reports an error
+                bool closed{false};
+                /// Wake ups read from the signal, but not yet used
+                uint64_t tokens{};
+            };
+            /// State shared with the outstanding signal reads
+            struct state {
+                state(boost::asio::io_service &ios) : ready{ios} {}
+
+                /// Mutex that controls access to the sources
+                std::mutex exclusive;
+                /// The sources being selected over
+                std::vector<std::unique_ptr<source>> sources;
+                /// Wakes the consumers when a source is signalled
+                threading::fd::unlimited ready;
+                /// The number of consumers waiting on ready
+                std::size_t waiting{};
+                /// Set when the select has been destroyed
+                bool abandoned{false};
+            };
+            std::shared_ptr<state> self;
+            /// The source to check first on the next consume
+            std::size_t next{};
+
+            /// Start a read on the source's signal. There must already be
+            /// a lock covering the sources.
+            void arm(std::size_t index) {
+                auto &src = *self->sources[index];
+                src.armed = true;
+                src.signal->async_consume(
+                        src.count, [s = self, index](auto error, auto count) {
+                            std::lock_guard<std::mutex> lock{s->exclusive};
+                            auto &src = *s->sources[index];
+                            src.armed = false;
+                            if (error) {
+                                src.closed = true;
+                            } else if (s->abandoned) {
+                                /// Nobody is going to use the wake up so
+                                /// hand it back to the source
+                                if (src.signal->is_open()) {
+                                    src.signal->produced(count);
+                                }
+                                return;
+                            } else {
+                                src.tokens += count;
+                            }
+                            for (; s->waiting; --s->waiting) {
+                                s->ready.produced();
+                            }
+                        });
+            }
+
+            /// Add a source to select over
+            std::size_t add(
+                    std::function<std::optional<V>()> take,
+                    threading::fd::unlimited &signal) {
+                std::lock_guard<std::mutex> lock{self->exclusive};
+                self->sources.push_back(std::make_unique<source>());
+                self->sources.back()->take = std::move(take);
+                self->sources.back()->signal = &signal;
+                arm(self->sources.size() - 1);
+                return self->sources.size() - 1;
+            }
+
+          public:
+            /// Construct for the specified IO service and sources
+            template<typename... Ss>
+            explicit select(boost::asio::io_service &ios, Ss &... ss)
+            : self{std::make_shared<state>(ios)} {
+                (add(ss), ...);
+            }
+            /// Hand back any wake ups that are read after destruction
+            ~select() {
+                std::lock_guard<std::mutex> lock{self->exclusive};
+                self->abandoned = true;
+                for (auto &src : self->sources) {
+                    if (src->tokens && src->signal->is_open()) {
+                        src->signal->produced(src->tokens);
+                    }
+                }
+            }
+
+            /// Make non-copyable and non assignable
+            select(const select &) = delete;
+            select &operator=(const select &) = delete;
+
+            /// Add a queue to select over. Returns its index.
+            template<typename S>
+            std::size_t add(queue<V, S> &q) {
+                return add([&q]() { return q.consume(); }, q.signal);
+            }
+            /// Add a channel to select over. Returns its index.
+            std::size_t add(channel<V> &c) {
+                return add(
+                        [&c]() -> std::optional<V> {
+                            if (auto item = c.buffer.consume()) {
+                                return std::move(item->second);
+                            } else {
+                                return {};
+                            }
+                        },
+                        c.buffer.signal);
+            }
+
+            /// Yield until one of the sources has an item and return the
+            /// index of the source along with the item. Sources that have
+            /// been closed are still consumed from until they are empty.
+            /// Once every source is closed and empty an error is thrown.
+            std::pair<std::size_t, V>
+                    consume(boost::asio::yield_context yield) {
+                std::unique_lock<std::mutex> lock{self->exclusive};
+                while (true) {
+                    auto &sources = self->sources;
+                    bool open = false;
+                    for (std::size_t offset{}; offset < sources.size();
+                         ++offset) {
+                        const auto index = (next + offset) % sources.size();
+                        auto &src = *sources[index];
+                        /// A closed source is still drained of the items
+                        /// it holds
+                        if (auto item = src.take()) {
+                            if (src.tokens) { --src.tokens; }
+                            if (not src.armed && not src.tokens
+                                && not src.closed) {
+                                arm(index);
+                            }
+                            next = index + 1;
+                            return {index, std::move(*item)};
+                        }
+                        if (not src.closed) { open = true; }
+                    }
+                    if (not open) {
+                        throw boost::system::system_error{
+                                boost::asio::error::operation_aborted};
+                    }
+                    /// All of the sources are empty so any wake ups we
+                    /// hold are for items somebody else has taken
+                    for (std::size_t index{}; index < sources.size();
+                         ++index) {
+                        auto &src = *sources[index];
+                        src.tokens = 0;
+                        if (not src.armed && not src.closed) { arm(index); }
+                    }
+                    ++self->waiting;
+                    lock.unlock();
+                    self->ready.consume(yield);
+                    lock.lock();
+                }
+            }
+        };
+
+
+    }
+
+
+}
@@ -92,7 +92,7 @@ namespace f5 {
             bool remove(const V &s) {
                 std::unique_lock<std::mutex> lock(mutex);
                 auto item = lower_bound(s);
-                if (item == set.end())
+                if (item == set.end() || not(*item == s))
                     return false;
                 else {
                     set.erase(item);
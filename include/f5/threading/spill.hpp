@@ -0,0 +1,282 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/queue.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace f5 {
+
+
+    inline namespace threading {
+
+
+        /// Turns trivially copyable values into bytes and back again.
+        /// Other types need a serialiser with the same `save` and `load`
+        /// members.
+        template<typename T>
+        struct trivial_serialiser {
+            static_assert(
+                    std::is_trivially_copyable_v<T>,
+                    "trivial_serialiser needs a trivially copyable type");
+
+            /// Append the bytes for the value to the string
+            void save(const T &t, std::string &into) const {
+                into.append(reinterpret_cast<const char *>(&t), sizeof(T));
+            }
+            /// Return the value the bytes are for
+            T load(std::string_view from) const {
+                T t;
+                std::memcpy(&t, from.data(), sizeof(T));
+                return t;
+            }
+        };
+
+
+        namespace fd {
+
+
+            /// An anonymous file used to hold data that doesn't fit in
+            /// memory. The file is unlinked as soon as it is created so
+            /// it goes away when it's closed.
+            class scratch_file {
+                int fd;
+
+              public:
+                /// Create a scratch file in the directory
+                scratch_file(const std::filesystem::path &directory) {
+                    auto name = (directory / "f5-threading-XXXXXX").string();
+                    fd = ::mkstemp(name.data());
+                    if (fd < 0) {
+                        throw std::system_error(errno, std::system_category());
+                    }
+                    ::unlink(name.c_str());
+                }
+                ~scratch_file() { ::close(fd); }
+
+                /// Make non-copyable and non assignable
+                scratch_file(const scratch_file &) = delete;
+                scratch_file &operator=(const scratch_file &) = delete;
+
+                /// Write all of the data at the offset
+                void write(uint64_t offset, std::string_view data) {
+                    while (not data.empty()) {
+                        const auto written =
+                                ::pwrite(fd, data.data(), data.size(), offset);
+                        if (written < 0) {
+                            if (errno == EINTR) { continue; }
+                            throw std::system_error(
+                                    errno, std::system_category());
+                        }
+                        data.remove_prefix(written);
+                        offset += written;
+                    }
+                }
+                /// Append up to `size` bytes from the offset to the string.
+                /// Returns the number of bytes read.
+                std::size_t read(
+                        uint64_t offset, std::size_t size, std::string &into) {
+                    const auto start = into.size();
+                    into.resize(start + size);
+                    while (true) {
+                        const auto got =
+                                ::pread(fd, into.data() + start, size, offset);
+                        if (got < 0) {
+                            if (errno == EINTR) { continue; }
+                            into.resize(start);
+                            throw std::system_error(
+                                    errno, std::system_category());
+                        }
+                        into.resize(start + got);
+                        return got;
+                    }
+                }
+                /// Throw away the content of the file
+                void clear() {
+                    if (::ftruncate(fd, 0) < 0) {
+                        throw std::system_error(errno, std::system_category());
+                    }
+                }
+            };
+
+
+        }
+
+
+    }
+
+
+    namespace boost_asio {
+
+
+        /// Storage for a queue that keeps a bounded number of items in
+        /// memory. Up to `head` items waiting to be consumed next and up
+        /// to `tail` of the most recently produced items are held in
+        /// memory. When the tail fills up it is appended to a scratch
+        /// file in one write, and the items are streamed back from the
+        /// file in order as the consumers catch up. Producers never have
+        /// to wait and no items are dropped.
+        ///
+        /// The file is written and read whilst the queue holds its lock.
+        template<typename T, typename Z = threading::trivial_serialiser<T>>
+        class spilling_store {
+            /// Items to be consumed next
+            std::deque<T> head;
+            /// Items most recently produced
+            std::deque<T> tail;
+            std::size_t head_limit, tail_limit;
+            /// Where the scratch file is created
+            std::filesystem::path directory;
+            /// Created the first time the tail is spilled
+            std::unique_ptr<threading::fd::scratch_file> file;
+            /// The number of items in the file
+            std::size_t spilled{};
+            /// Where the next spill is written
+            uint64_t write_offset{};
+            /// Where the next read from the file comes from
+            uint64_t read_offset{};
+            /// Bytes read from the file that haven't been used yet
+            std::string buffer;
+            std::size_t buffer_pos{};
+            Z serialiser;
+
+            /// Each item in the file is preceded by its size
+            using length_type = uint32_t;
+            /// How much to read from the file at a time
+            static constexpr std::size_t read_size = 64 << 10;
+
+            /// Make sure that at least `size` unread bytes are in the
+            /// buffer
+            void fill(std::size_t size) {
+                while (buffer.size() - buffer_pos < size) {
+                    buffer.erase(0, buffer_pos);
+                    buffer_pos = 0;
+                    const auto got = file->read(
+                            read_offset, std::max(read_size, size), buffer);
+                    if (not got) {
+                        throw std::runtime_error{
+                                "Spill file is shorter than expected"};
+                    }
+                    read_offset += got;
+                }
+            }
+            /// Read the next item from the file
+            T unspill() {
+                fill(sizeof(length_type));
+                length_type length;
+                std::memcpy(
+                        &length, buffer.data() + buffer_pos,
+                        sizeof(length_type));
+                buffer_pos += sizeof(length_type);
+                fill(length);
+                auto t = serialiser.load(
+                        std::string_view{buffer}.substr(buffer_pos, length));
+                buffer_pos += length;
+                --spilled;
+                return t;
+            }
+            /// Write the whole of the tail to the file
+            void spill() {
+                if (not file) {
+                    file = std::make_unique<threading::fd::scratch_file>(
+                            directory);
+                }
+                std::string bytes;
+                for (auto &t : tail) {
+                    const auto start = bytes.size();
+                    bytes.append(sizeof(length_type), '\0');
+                    serialiser.save(t, bytes);
+                    const length_type length =
+                            bytes.size() - start - sizeof(length_type);
+                    std::memcpy(
+                            bytes.data() + start, &length,
+                            sizeof(length_type));
+                }
+                file->write(write_offset, bytes);
+                write_offset += bytes.size();
+                spilled += tail.size();
+                tail.clear();
+            }
+            /// Top up the head from the file and then the tail
+            void refill() {
+                while (spilled && head.size() < head_limit) {
+                    head.push_back(unspill());
+                }
+                if (not spilled && write_offset) {
+                    /// Everything has been read back so start the file
+                    /// again from the beginning
+                    file->clear();
+                    write_offset = read_offset = 0;
+                    buffer.clear();
+                    buffer_pos = 0;
+                }
+                while (not spilled && not tail.empty()
+                       && head.size() < head_limit) {
+                    head.push_back(std::move(tail.front()));
+                    tail.pop_front();
+                }
+            }
+
+          public:
+            using value_type = T;
+
+            /// Construct with the number of items to keep in memory at
+            /// the head and tail of the queue
+            spilling_store(
+                    std::size_t h,
+                    std::size_t t,
+                    std::filesystem::path d =
+                            std::filesystem::temp_directory_path(),
+                    Z z = Z())
+            : head_limit{std::max(h, std::size_t{1})},
+              tail_limit{std::max(t, std::size_t{1})},
+              directory{std::move(d)},
+              serialiser{std::move(z)} {}
+
+            /// Add an item to the back
+            void push_back(T t) {
+                if (not spilled && tail.empty() && head.size() < head_limit) {
+                    head.push_back(std::move(t));
+                } else {
+                    tail.push_back(std::move(t));
+                    if (tail.size() >= tail_limit) { spill(); }
+                }
+            }
+            /// The next item to be consumed
+            T &front() { return head.front(); }
+            /// Remove the next item to be consumed
+            void pop_front() {
+                head.pop_front();
+                if (head.empty()) { refill(); }
+            }
+            /// The total number of items
+            std::size_t size() const {
+                return head.size() + spilled + tail.size();
+            }
+            /// The number of items currently in the scratch file
+            std::size_t spilled_size() const { return spilled; }
+        };
+
+
+    }
+
+
+}
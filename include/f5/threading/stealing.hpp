@@ -0,0 +1,464 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+
+namespace f5 {
+
+
+    inline namespace threading {
+
+
+        /// A Chase-Lev work stealing deque of pointers. The owning thread
+        /// pushes and pops at the bottom without locking, and any other
+        /// thread may steal from the top. The deque grows as needed. Old
+        /// arrays are kept until the deque is destroyed because a thief
+        /// may still be reading from one.
+        template<typename T>
+        class stealing_deque {
+            /// A power of two sized circular array
+            struct array {
+                explicit array(std::size_t s)
+                : size{s}, items{std::make_unique<std::atomic<T *>[]>(s)} {}
+
+                std::size_t size;
+                std::unique_ptr<std::atomic<T *>[]> items;
+
+                T *get(int64_t index) const {
+                    return items[index & (size - 1)].load(
+                            std::memory_order_relaxed);
+                }
+                void put(int64_t index, T *item) {
+                    items[index & (size - 1)].store(
+                            item, std::memory_order_relaxed);
+                }
+            };
+
+            std::atomic<int64_t> top{}, bottom{};
+            std::atomic<array *> buffer;
+            /// All of the arrays that have been used. Only the owner
+            /// touches this.
+            std::vector<std::unique_ptr<array>> arrays;
+
+          public:
+            /// Construct with space for the initial number of items,
+            /// which must be a power of two
+            explicit stealing_deque(std::size_t initial = 256) {
+                arrays.push_back(std::make_unique<array>(initial));
+                buffer.store(arrays.back().get(), std::memory_order_relaxed);
+            }
+
+            /// Make non-copyable and non assignable
+            stealing_deque(const stealing_deque &) = delete;
+            stealing_deque &operator=(const stealing_deque &) = delete;
+
+            /// Add an item to the bottom. Only the owner may call this.
+            void push(T *item) {
+                const auto b = bottom.load(std::memory_order_relaxed);
+                const auto t = top.load(std::memory_order_acquire);
+                auto a = buffer.load(std::memory_order_relaxed);
+                if (b - t > static_cast<int64_t>(a->size) - 1) {
+                    auto bigger = std::make_unique<array>(a->size * 2);
+                    for (auto i = t; i != b; ++i) { bigger->put(i, a->get(i)); }
+                    a = bigger.get();
+                    arrays.push_back(std::move(bigger));
+                    buffer.store(a, std::memory_order_release);
+                }
+                a->put(b, item);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            /// Take the most recently pushed item. Only the owner may call
+            /// this. Returns nullptr if the deque is empty.
+            T *pop() {
+                const auto b = bottom.load(std::memory_order_relaxed) - 1;
+                auto a = buffer.load(std::memory_order_relaxed);
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto t = top.load(std::memory_order_relaxed);
+                if (t > b) {
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                auto item = a->get(b);
+                if (t == b) {
+                    /// The last item, so race any thieves for it
+                    if (not top.compare_exchange_strong(
+                                t, t + 1, std::memory_order_seq_cst,
+                                std::memory_order_relaxed)) {
+                        item = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return item;
+            }
+            /// Take the oldest item. Any thread may call this. Returns
+            /// nullptr if the deque is empty or another thread got there
+            /// first.
+            T *steal() {
+                auto t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const auto b = bottom.load(std::memory_order_acquire);
+                if (t >= b) { return nullptr; }
+                const auto a = buffer.load(std::memory_order_acquire);
+                auto item = a->get(t);
+                if (not top.compare_exchange_strong(
+                            t, t + 1, std::memory_order_seq_cst,
+                            std::memory_order_relaxed)) {
+                    return nullptr;
+                }
+                return item;
+            }
+        };
+
+
+    }
+
+
+    namespace boost_asio {
+
+
+        /// A pool of threads for CPU bound work. Each thread has its own
+        /// deque of tasks and threads that run out of work steal from the
+        /// others, picked at random. Tasks posted from outside of the
+        /// pool go through a shared queue.
+        ///
+        /// The pool is an execution context so its executor can be used
+        /// with `boost::asio::post`. Coroutines running on an io_service
+        /// can use `run` to hand a function over to the pool and yield
+        /// until it has completed, leaving the io_service free to handle
+        /// I/O in the meantime.
+        class stealing_pool final : public boost::asio::execution_context {
+            /// Type erased, move only task
+            struct task {
+                virtual ~task() = default;
+                virtual void operator()() = 0;
+                /// Called instead of running the task when the pool is
+                /// closed before the task has started
+                virtual void abort() {}
+            };
+            template<typename F>
+            struct task_of final : public task {
+                F f;
+                task_of(F &&fn) : f{std::move(fn)} {}
+                void operator()() override { f(); }
+            };
+            /// A task that still has to report back if it is aborted. The
+            /// function is passed true when it is being aborted.
+            template<typename F>
+            struct abortable_task final : public task {
+                F f;
+                abortable_task(F &&fn) : f{std::move(fn)} {}
+                void operator()() override { f(false); }
+                void abort() override { f(true); }
+            };
+            /// A thread and its deque
+            struct worker {
+                stealing_pool *pool;
+                stealing_deque<task> tasks;
+                std::thread thread;
+            };
+
+            std::vector<std::unique_ptr<worker>> workers;
+            /// Tasks posted from threads that aren't in the pool
+            std::mutex injection_mutex;
+            std::deque<task *> injected;
+            /// Used by workers to sleep when they can't find anything
+            std::mutex sleep_mutex;
+            std::condition_variable wake;
+            std::atomic<std::size_t> sleeping{};
+            /// Changes every time a task is posted so a worker can tell
+            /// whether it missed one before going to sleep
+            std::atomic<uint64_t> posted{};
+            std::atomic<bool> stopping{false};
+
+            /// The worker running on this thread, if any
+            static worker *&current() {
+                static thread_local worker *w{};
+                return w;
+            }
+            /// A random number for choosing a victim to steal from
+            static std::size_t random() {
+                static thread_local uint64_t state =
+                        std::hash<std::thread::id>{}(std::this_thread::get_id())
+                        | 1;
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return state;
+            }
+
+            /// Add a task to the current worker's deque, or the shared
+            /// queue if this isn't one of the pool's threads
+            void submit(task *t) {
+                auto w = current();
+                if (w && w->pool == this) {
+                    w->tasks.push(t);
+                } else {
+                    std::lock_guard<std::mutex> lock{injection_mutex};
+                    injected.push_back(t);
+                }
+                posted.fetch_add(1);
+                if (sleeping.load()) {
+                    std::lock_guard<std::mutex> lock{sleep_mutex};
+                    wake.notify_one();
+                }
+            }
+            /// Find a task for the worker to run
+            task *find(worker &w) {
+                if (auto t = w.tasks.pop(); t) { return t; }
+                {
+                    std::lock_guard<std::mutex> lock{injection_mutex};
+                    if (not injected.empty()) {
+                        auto t = injected.front();
+                        injected.pop_front();
+                        return t;
+                    }
+                }
+                const auto start = random();
+                for (std::size_t i{}; i != workers.size(); ++i) {
+                    auto &victim = *workers[(start + i) % workers.size()];
+                    if (&victim == &w) { continue; }
+                    if (auto t = victim.tasks.steal(); t) { return t; }
+                }
+                return nullptr;
+            }
+            /// Run tasks until the pool is stopped
+            template<typename F>
+            void work(worker &w, F &exception_handler) {
+                current() = &w;
+                while (not stopping.load()) {
+                    const auto seen = posted.load();
+                    if (auto t = find(w); t) {
+                        std::unique_ptr<task> owned{t};
+                        try {
+                            (*owned)();
+                        } catch (boost::coroutines::detail::forced_unwind &) {
+                            throw;
+                        } catch (...) {
+                            if (not exception_handler()) { break; }
+                        }
+                    } else {
+                        std::unique_lock<std::mutex> lock{sleep_mutex};
+                        ++sleeping;
+                        wake.wait(lock, [&]() {
+                            return posted.load() != seen || stopping.load();
+                        });
+                        --sleeping;
+                    }
+                }
+                current() = nullptr;
+            }
+
+          public:
+            /// Executor for posting work to the pool
+            class executor_type {
+                friend class stealing_pool;
+                stealing_pool *pool;
+                explicit executor_type(stealing_pool &p) : pool{&p} {}
+
+              public:
+                stealing_pool &context() const noexcept { return *pool; }
+                void on_work_started() const noexcept {}
+                void on_work_finished() const noexcept {}
+
+                /// Run the function straight away if this is one of the
+                /// pool's threads, otherwise post it
+                template<typename F, typename A>
+                void dispatch(F &&f, const A &a) const {
+                    if (pool->running_in_this_thread()) {
+                        std::decay_t<F> run{std::forward<F>(f)};
+                        run();
+                    } else {
+                        post(std::forward<F>(f), a);
+                    }
+                }
+                template<typename F, typename A>
+                void post(F &&f, const A &) const {
+                    pool->post(std::forward<F>(f));
+                }
+                template<typename F, typename A>
+                void defer(F &&f, const A &a) const {
+                    post(std::forward<F>(f), a);
+                }
+
+                bool operator==(const executor_type &e) const noexcept {
+                    return pool == e.pool;
+                }
+                bool operator!=(const executor_type &e) const noexcept {
+                    return pool != e.pool;
+                }
+            };
+
+            /// Default construct a pool with a thread per hardware thread
+            /// that will terminate threads if exceptions leak
+            stealing_pool() : stealing_pool([]() { return false; }) {}
+
+            /// Construct a pool with the requested thread count and using
+            /// the passed in exception handler. The handler works the same
+            /// as the one for `reactor_pool`.
+            template<typename F>
+            explicit stealing_pool(
+                    F exception_handler,
+                    std::size_t thread_count =
+                            std::thread::hardware_concurrency()) {
+                thread_count = std::max(thread_count, std::size_t{1});
+                for (auto t = 0u; t != thread_count; ++t) {
+                    workers.push_back(std::make_unique<worker>());
+                    workers.back()->pool = this;
+                }
+                for (auto &w : workers) {
+                    w->thread = std::thread{
+                            [this, &w = *w, exception_handler]() mutable {
+                                work(w, exception_handler);
+                            }};
+                }
+            }
+
+            /// Stop the threads. Tasks that haven't started are discarded,
+            /// apart from those handed over by `run`, whose coroutines
+            /// carry on with an `operation_aborted` error.
+            void close() {
+                {
+                    std::lock_guard<std::mutex> lock{sleep_mutex};
+                    stopping = true;
+                    wake.notify_all();
+                }
+                for (auto &w : workers) {
+                    if (w->thread.joinable()) { w->thread.join(); }
+                }
+                auto discard = [](task *t) {
+                    std::unique_ptr<task> owned{t};
+                    owned->abort();
+                };
+                for (auto &w : workers) {
+                    while (auto t = w->tasks.pop()) { discard(t); }
+                }
+                std::deque<task *> pending;
+                {
+                    std::lock_guard<std::mutex> lock{injection_mutex};
+                    pending.swap(injected);
+                }
+                for (auto t : pending) { discard(t); }
+            }
+            ~stealing_pool() {
+                close();
+                shutdown();
+                destroy();
+            }
+
+            /// Make non-copyable and non assignable
+            stealing_pool(const stealing_pool &) = delete;
+            stealing_pool &operator=(const stealing_pool &) = delete;
+
+            /// Return the number of threads in the pool
+            std::size_t size() const { return workers.size(); }
+
+            /// Return an executor for the pool
+            executor_type get_executor() { return executor_type{*this}; }
+
+            /// Return true if the calling thread is one of the pool's
+            bool running_in_this_thread() const {
+                auto w = current();
+                return w && w->pool == this;
+            }
+
+            /// Post a function to be run by the pool
+            template<typename F>
+            void post(F &&f) {
+                submit(new task_of<std::decay_t<F>>{
+                        std::decay_t<F>{std::forward<F>(f)}});
+            }
+
+            /// Run the function on the pool, yielding the coroutine until
+            /// it has finished. The coroutine carries on in its own
+            /// executor and any exception the function throws is rethrown
+            /// there. If the pool is closed before the function starts a
+            /// `boost::system::system_error` with `operation_aborted` is
+            /// thrown instead.
+            template<typename F>
+            auto run(F fn, boost::asio::yield_context yield) {
+                using R = decltype(fn());
+                using result_type = std::conditional_t<
+                        std::is_void_v<R>, std::monostate, R>;
+                /// Lives in the coroutine's frame until it carries on
+                std::optional<result_type> result;
+                boost::asio::async_completion<
+                        boost::asio::yield_context, void(std::exception_ptr)>
+                        init{yield};
+                /// Stops the coroutine's io_service from running out of
+                /// work whilst the function is running
+                auto work = boost::asio::make_work_guard(
+                        boost::asio::get_associated_executor(
+                                init.completion_handler));
+                auto handoff = [&result, &fn, work = std::move(work),
+                                handler = std::move(init.completion_handler)](
+                                       bool aborted) mutable {
+                    std::exception_ptr error;
+                    if (aborted) {
+                        error = std::make_exception_ptr(
+                                boost::system::system_error{
+                                        boost::asio::error::operation_aborted});
+                    } else {
+                        try {
+                            if constexpr (std::is_void_v<R>) {
+                                fn();
+                                result.emplace();
+                            } else {
+                                result.emplace(fn());
+                            }
+                        } catch (...) { error = std::current_exception(); }
+                    }
+                    auto ex = boost::asio::get_associated_executor(handler);
+                    boost::asio::post(
+                            ex,
+                            [handler = std::move(handler), error]() mutable {
+                                handler(error);
+                            });
+                    work.reset();
+                };
+                submit(new abortable_task<decltype(handoff)>{
+                        std::move(handoff)});
+                if (auto error = init.result.get(); error) {
+                    std::rethrow_exception(error);
+                }
+                if constexpr (not std::is_void_v<R>) {
+                    return std::move(*result);
+                }
+            }
+        };
+
+
+    }
+
+
+}
@@ -0,0 +1,240 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <f5/threading/channel.hpp>
+#include <f5/threading/reactor.hpp>
+
+#include <deque>
+#include <future>
+#include <memory>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// Whether a transform keeps its results in the input order
+        enum class ordering {
+            /// Results are produced in the order the input arrived
+            preserved,
+            /// Results are produced as soon as they are ready
+            unordered
+        };
+
+
+        namespace detail {
+
+
+            /// The shared state for a running transform stage
+            template<typename I, typename O, typename F>
+            struct transform_stage {
+                transform_stage(
+                        boost::asio::io_service &ios,
+                        channel<I> &i,
+                        channel<O> &o,
+                        F f,
+                        std::size_t concurrency,
+                        ordering ord)
+                : in{i},
+                  out{o},
+                  fn{std::move(f)},
+                  order{ord},
+                  throttle{ios, concurrency},
+                  completed{ios} {}
+
+                /// An item being worked on
+                struct slot {
+                    /// Holds the place of the item in the limiter until
+                    /// its result has been produced downstream
+                    std::unique_ptr<threading::fd::limiter::job> job;
+                    std::optional<O> result;
+                    std::exception_ptr error;
+                    bool done{false};
+                };
+
+                channel<I> &in;
+                channel<O> &out;
+                F fn;
+                ordering order;
+                /// Bounds the number of items that are in flight
+                threading::fd::limiter throttle;
+                /// Wakes the writer when an item has been worked on
+                threading::fd::unlimited completed;
+
+                /// Mutex that controls access to the slots
+                std::mutex exclusive;
+                /// The items in flight, in input order
+                std::deque<std::unique_ptr<slot>> pending;
+                /// Set once the input channel has been closed
+                bool exhausted{false};
+                /// Set whilst the writer is waiting on completed
+                bool waiting{false};
+                /// Set once the stage has stopped because of an error
+                bool failed{false};
+                /// Reports how the stage finished
+                std::promise<void> finished;
+
+                /// Stop the stage because of the exception and report it.
+                /// The channels belong to the caller so they are left for
+                /// the caller to close.
+                void fail(std::exception_ptr e) {
+                    std::unique_lock<std::mutex> lock{exclusive};
+                    if (failed) { return; }
+                    failed = true;
+                    lock.unlock();
+                    finished.set_exception(std::move(e));
+                }
+
+                /// Wake the writer if it is waiting. There must already
+                /// be a lock covering the slots.
+                void wake() {
+                    if (waiting) {
+                        waiting = false;
+                        completed.produced();
+                    }
+                }
+
+                /// Return the next slot whose result can be produced, if
+                /// there is one. There must already be a lock covering
+                /// the slots.
+                std::unique_ptr<slot> next_done() {
+                    auto pos = pending.begin();
+                    if (order == ordering::unordered) {
+                        while (pos != pending.end() && not(*pos)->done) {
+                            ++pos;
+                        }
+                    }
+                    if (pos == pending.end() || not(*pos)->done) {
+                        return {};
+                    }
+                    auto s = std::move(*pos);
+                    pending.erase(pos);
+                    return s;
+                }
+            };
+
+
+        }
+
+
+        /// Start a pipeline stage that reads items from `in`, applies
+        /// `fn` to them on the threads of the pool and produces the
+        /// results to `out`. No more than `concurrency` items are in
+        /// flight at any time, so a full `out` channel holds up reading
+        /// from `in`.
+        ///
+        /// The stage runs until `in` is closed, after which the items
+        /// already in flight are still produced to `out`. The returned
+        /// future is ready once the stage has finished and no longer
+        /// uses the channels.
+        ///
+        /// If `fn` throws, or `out` is closed, then the stage stops and
+        /// the future holds the exception straight away. The results
+        /// still in flight are dropped. The channels belong to the caller
+        /// and are never closed by the stage, but it keeps waiting on
+        /// `in` until the next item arrives or `in` is closed, and drops
+        /// that item.
+        template<typename I, typename O, typename F>
+        std::future<void> transform(
+                reactor_pool &pool,
+                channel<I> &in,
+                channel<O> &out,
+                F fn,
+                std::size_t concurrency,
+                ordering order = ordering::preserved) {
+            using stage_type = detail::transform_stage<I, O, F>;
+            using slot_type = typename stage_type::slot;
+            auto &ios = pool.get_io_service();
+            auto stage = std::make_shared<stage_type>(
+                    ios, in, out, std::move(fn), concurrency, order);
+            auto finished = stage->finished.get_future();
+
+            boost::asio::spawn(ios, [stage, &ios](auto yield) {
+                try {
+                    while (true) {
+                        auto job = stage->throttle.next_job(yield);
+                        auto item = stage->in.consume(yield);
+                        auto s = std::make_unique<slot_type>();
+                        s->job = std::move(job);
+                        auto *place = s.get();
+                        std::unique_lock<std::mutex> lock{stage->exclusive};
+                        if (stage->failed) { break; }
+                        stage->pending.push_back(std::move(s));
+                        lock.unlock();
+                        ios.post([stage, place,
+                                  item = std::move(item)]() mutable {
+                            try {
+                                place->result.emplace(
+                                        stage->fn(std::move(item)));
+                            } catch (...) {
+                                place->error = std::current_exception();
+                            }
+                            std::lock_guard<std::mutex> lock{
+                                    stage->exclusive};
+                            place->done = true;
+                            stage->wake();
+                        });
+                    }
+                } catch (boost::system::system_error &) {
+                    /// The input channel has been closed
+                }
+                std::lock_guard<std::mutex> lock{stage->exclusive};
+                stage->exhausted = true;
+                stage->wake();
+            });
+
+            boost::asio::spawn(ios, [stage](auto yield) {
+                std::unique_lock<std::mutex> lock{stage->exclusive};
+                while (true) {
+                    if (auto s = stage->next_done(); s) {
+                        const bool failed = stage->failed;
+                        lock.unlock();
+                        /// Once the stage has failed the results are
+                        /// dropped, which frees their places in the
+                        /// limiter so that the reader can finish
+                        if (not failed && s->error) {
+                            stage->fail(s->error);
+                        } else if (not failed) {
+                            try {
+                                stage->out.produce(
+                                        std::move(*s->result), yield);
+                            } catch (boost::system::system_error &) {
+                                /// The output channel has been closed
+                                stage->fail(std::current_exception());
+                            }
+                        }
+                        s.reset();
+                        lock.lock();
+                    } else if (stage->exhausted && stage->pending.empty()) {
+                        if (not stage->failed) {
+                            lock.unlock();
+                            stage->finished.set_value();
+                        }
+                        return;
+                    } else {
+                        stage->waiting = true;
+                        lock.unlock();
+                        stage->completed.consume(yield);
+                        lock.lock();
+                    }
+                }
+            });
+
+            return finished;
+        }
+
+
+    }
+
+
+}
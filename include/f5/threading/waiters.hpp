@@ -0,0 +1,125 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/spawn.hpp>
+
+#include <mutex>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        namespace detail {
+
+
+            /// A list of coroutines that are suspended until they are
+            /// woken. Each entry lives on the stack of the coroutine that
+            /// is waiting, so adding a waiter never allocates. The list
+            /// is protected by the mutex of the type that uses it.
+            class waiters {
+                struct node {
+                    node *next = nullptr;
+                    virtual void resume() = 0;
+                };
+                template<typename H>
+                struct node_of final : public node {
+                    H handler;
+                    explicit node_of(H h) : handler{std::move(h)} {}
+                    /// Post the handler to its own executor. The node may
+                    /// be gone as soon as this has been done.
+                    void resume() override {
+                        auto ex = boost::asio::get_associated_executor(handler);
+                        boost::asio::post(ex, std::move(handler));
+                    }
+                };
+
+                node *head = nullptr, **tail = &head;
+
+              public:
+                /// The waiters taken out of a list, ready to be woken
+                class woken {
+                    node *first;
+                    friend class waiters;
+                    explicit woken(node *f) : first{f} {}
+
+                  public:
+                    woken(woken &&w) : first{w.first} { w.first = nullptr; }
+                    woken(const woken &) = delete;
+                    woken &operator=(const woken &) = delete;
+                    /// Wake any that are left
+                    ~woken() { resume(); }
+
+                    /// Wake the coroutines. There should be no lock held
+                    /// whilst this is done.
+                    void resume() {
+                        while (first) {
+                            auto n = first;
+                            first = n->next;
+                            n->resume();
+                        }
+                    }
+                };
+
+                /// Suspend the coroutine until it is woken. The lock must
+                /// cover the list and is released whilst the coroutine is
+                /// suspended. It is not held again when this returns.
+                void wait(
+                        std::unique_lock<std::mutex> &lock,
+                        boost::asio::yield_context yield) {
+                    boost::asio::async_completion<
+                            boost::asio::yield_context, void()>
+                            init{yield};
+                    node_of<std::decay_t<decltype(init.completion_handler)>>
+                            waiting{std::move(init.completion_handler)};
+                    *tail = &waiting;
+                    tail = &waiting.next;
+                    lock.unlock();
+                    init.result.get();
+                }
+
+                /// True if there are no coroutines waiting. There must be
+                /// a lock covering the list.
+                bool empty() const { return head == nullptr; }
+
+                /// Take all of the waiters out of the list. There must be
+                /// a lock covering the list.
+                woken take() {
+                    auto first = head;
+                    head = nullptr;
+                    tail = &head;
+                    return woken{first};
+                }
+                /// Take the longest waiting coroutine out of the list, if
+                /// there is one. There must be a lock covering the list.
+                woken take_one() {
+                    auto first = head;
+                    if (first) {
+                        head = first->next;
+                        if (not head) { tail = &head; }
+                        first->next = nullptr;
+                    }
+                    return woken{first};
+                }
+            };
+
+
+        }
+
+
+    }
+
+
+}
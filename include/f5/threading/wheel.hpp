@@ -0,0 +1,359 @@
+/**
+    Copyright 2026 Red Anchor Trading Co. Ltd.
+
+    Distributed under the Boost Software License, Version 1.0.
+    See <http://www.boost.org/LICENSE_1_0.txt>
+ */
+
+
+#pragma once
+
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace f5 {
+
+
+    namespace boost_asio {
+
+
+        /// A hierarchical timer wheel for very large numbers of timeouts.
+        /// Setting and cancelling a timer are O(1) no matter how many
+        /// timers there are, at the cost of the timers only being as
+        /// accurate as the wheel's resolution. A single asio timer drives
+        /// the wheel and it is only running whilst there are timers
+        /// waiting.
+        ///
+        /// The wheel has four levels of 64 slots, so timers up to 64^4
+        /// ticks away are placed directly and longer ones are moved down
+        /// the levels as time passes.
+        class timer_wheel {
+            static constexpr std::size_t slot_bits = 6;
+            static constexpr std::size_t slots = 1u << slot_bits;
+            static constexpr std::size_t levels = 4;
+            static constexpr uint64_t span = uint64_t{1}
+                    << (slot_bits * levels);
+
+            using clock_type = std::chrono::steady_clock;
+
+            /// Links in a circular list of timers. Each slot has one
+            /// that marks the start and end of its list.
+            struct node {
+                node *prev = this, *next = this;
+
+                void unlink() {
+                    prev->next = next;
+                    next->prev = prev;
+                    prev = next = this;
+                }
+                void push_back(node &n) {
+                    n.prev = prev;
+                    n.next = this;
+                    prev->next = &n;
+                    prev = &n;
+                }
+                bool empty() const { return next == this; }
+            };
+
+            /// A handler waiting for a timer
+            struct pending {
+                virtual ~pending() = default;
+                virtual void complete(boost::system::error_code) = 0;
+            };
+            template<typename H>
+            struct pending_of final : public pending {
+                H handler;
+                boost::asio::io_service::executor_type fallback;
+
+                pending_of(H h, boost::asio::io_service::executor_type f)
+                : handler{std::move(h)}, fallback{f} {}
+
+                /// Post the handler to its own executor
+                void complete(boost::system::error_code error) override {
+                    auto ex = boost::asio::get_associated_executor(
+                            handler, fallback);
+                    boost::asio::post(
+                            ex,
+                            [handler = std::move(handler), error]() mutable {
+                                handler(error);
+                            });
+                }
+            };
+
+          public:
+            class timer;
+
+          private:
+            boost::asio::io_service &ios;
+            /// The length of a tick
+            clock_type::duration resolution;
+            /// The time of tick zero
+            clock_type::time_point start;
+            /// The driver's handler holds on to this instead of the wheel
+            /// so that it can tell if the wheel has been destroyed whilst
+            /// the handler was queued
+            struct lifetime {
+                std::mutex exclusive;
+                bool alive{true};
+            };
+            std::shared_ptr<lifetime> life{std::make_shared<lifetime>()};
+            /// Mutex that controls access to the wheel
+            std::mutex &exclusive{life->exclusive};
+            std::array<std::array<node, slots>, levels> wheel;
+            /// The tick the wheel has reached
+            uint64_t current{};
+            /// The number of timers in the wheel
+            std::size_t count{};
+            /// Ticks the wheel over
+            boost::asio::steady_timer driver;
+            bool driving{false};
+
+            /// The first tick at or after the time
+            uint64_t tick_of(clock_type::time_point when) const {
+                if (when <= start) { return 0; }
+                return (when - start + resolution - clock_type::duration{1})
+                        / resolution;
+            }
+            /// The number of whole ticks that have passed
+            uint64_t elapsed() const {
+                return (clock_type::now() - start) / resolution;
+            }
+            /// Put the timer into the slot for its due tick. There must
+            /// already be a lock covering the wheel.
+            void insert(timer &t);
+            /// Move the timers in a slot down to lower levels. There must
+            /// already be a lock covering the wheel.
+            void cascade(std::size_t level) {
+                auto &slot = wheel[level][(current >> (slot_bits * level))
+                                          & (slots - 1)];
+                /// Take the whole list first as timers that are still a
+                /// long way off may go back into the same slot
+                node moving;
+                while (not slot.empty()) {
+                    auto &n = *slot.next;
+                    n.unlink();
+                    moving.push_back(n);
+                }
+                while (not moving.empty()) {
+                    auto &n = *moving.next;
+                    n.unlink();
+                    insert(static_cast<timer &>(n));
+                }
+            }
+            /// Move the wheel on to the tick, collecting the handlers of
+            /// the timers that are due. There must already be a lock
+            /// covering the wheel.
+            void advance(
+                    uint64_t to, std::vector<std::unique_ptr<pending>> &due);
+            /// Set the driver for the next tick. There must already be a
+            /// lock covering the wheel.
+            void drive() {
+                if (driving || not count) { return; }
+                driving = true;
+                driver.expires_at(
+                        start
+                        + static_cast<clock_type::rep>(current + 1)
+                                * resolution);
+                driver.async_wait([this, weak = std::weak_ptr<lifetime>{life}](
+                                          auto error) {
+                    auto l = weak.lock();
+                    if (error || not l) { return; }
+                    std::vector<std::unique_ptr<pending>> due;
+                    {
+                        std::lock_guard<std::mutex> lock{l->exclusive};
+                        if (not l->alive) { return; }
+                        driving = false;
+                        advance(elapsed(), due);
+                        drive();
+                    }
+                    for (auto &p : due) {
+                        p->complete(boost::system::error_code{});
+                    }
+                });
+            }
+
+          public:
+            /// A timer in the wheel. It must be destroyed before the
+            /// wheel is.
+            class timer : private node {
+                friend class timer_wheel;
+                timer_wheel &owner;
+                /// The tick the timer is due at
+                uint64_t due{};
+                /// The time the timer is due at
+                clock_type::time_point expiry;
+                std::unique_ptr<pending> waiting;
+
+              public:
+                /// Construct a timer for the wheel
+                explicit timer(timer_wheel &w) : owner{w} {}
+                ~timer() { cancel(); }
+
+                /// Make non-copyable and non assignable
+                timer(const timer &) = delete;
+                timer &operator=(const timer &) = delete;
+
+                /// Set the time the timer is due. Any wait in progress is
+                /// cancelled.
+                std::size_t expires_at(clock_type::time_point when) {
+                    const auto cancelled = cancel();
+                    expiry = when;
+                    return cancelled;
+                }
+                /// Set the timer to be due after the duration. Any wait
+                /// in progress is cancelled.
+                template<typename Rep, typename Period>
+                std::size_t
+                        expires_after(std::chrono::duration<Rep, Period> d) {
+                    return expires_at(clock_type::now() + d);
+                }
+
+                /// Wait for the timer to be due. The handler is called
+                /// with `operation_aborted` if the timer is cancelled.
+                template<typename Token>
+                auto async_wait(Token &&token) {
+                    boost::asio::async_completion<
+                            Token, void(boost::system::error_code)>
+                            init{token};
+                    using handler_type =
+                            std::decay_t<decltype(init.completion_handler)>;
+                    owner.schedule(
+                            *this,
+                            std::make_unique<pending_of<handler_type>>(
+                                    std::move(init.completion_handler),
+                                    owner.ios.get_executor()));
+                    return init.result.get();
+                }
+
+                /// Cancel any wait in progress. Returns the number of
+                /// waits cancelled.
+                std::size_t cancel() {
+                    std::unique_ptr<pending> cancelled;
+                    {
+                        std::lock_guard<std::mutex> lock{owner.exclusive};
+                        if (not waiting) { return 0; }
+                        unlink();
+                        --owner.count;
+                        cancelled = std::move(waiting);
+                    }
+                    cancelled->complete(boost::asio::error::operation_aborted);
+                    return 1;
+                }
+            };
+
+            /// Construct a wheel for the io_service that ticks at the
+            /// resolution
+            timer_wheel(
+                    boost::asio::io_service &s,
+                    clock_type::duration r = std::chrono::milliseconds{10})
+            : ios{s},
+              resolution{r},
+              start{clock_type::now()},
+              driver{s} {}
+
+            /// Any timers still waiting are cancelled
+            ~timer_wheel() {
+                std::vector<std::unique_ptr<pending>> cancelled;
+                {
+                    std::lock_guard<std::mutex> lock{exclusive};
+                    life->alive = false;
+                    driver.cancel();
+                    for (auto &level : wheel) {
+                        for (auto &slot : level) {
+                            while (not slot.empty()) {
+                                auto &t = static_cast<timer &>(*slot.next);
+                                t.unlink();
+                                cancelled.push_back(std::move(t.waiting));
+                            }
+                        }
+                    }
+                    count = 0;
+                }
+                for (auto &p : cancelled) {
+                    p->complete(boost::asio::error::operation_aborted);
+                }
+            }
+
+            /// Make non-copyable and non assignable
+            timer_wheel(const timer_wheel &) = delete;
+            timer_wheel &operator=(const timer_wheel &) = delete;
+
+            /// The number of timers that are waiting
+            std::size_t size() {
+                std::lock_guard<std::mutex> lock{exclusive};
+                return count;
+            }
+
+          private:
+            /// Start a wait on the timer
+            void schedule(timer &t, std::unique_ptr<pending> p) {
+                std::unique_ptr<pending> replaced;
+                {
+                    std::lock_guard<std::mutex> lock{exclusive};
+                    if (t.waiting) {
+                        t.unlink();
+                        --count;
+                        replaced = std::move(t.waiting);
+                    }
+                    if (not count) {
+                        /// Nothing is waiting so the wheel can jump
+                        /// straight to now
+                        current = std::max(current, elapsed());
+                    }
+                    t.waiting = std::move(p);
+                    t.due = std::max(tick_of(t.expiry), current + 1);
+                    insert(t);
+                    ++count;
+                    drive();
+                }
+                if (replaced) {
+                    replaced->complete(boost::asio::error::operation_aborted);
+                }
+            }
+        };
+
+
+        inline void timer_wheel::insert(timer &t) {
+            const auto delta = std::min(t.due - current, span - 1);
+            std::size_t level{};
+            while (delta >> (slot_bits * (level + 1))) { ++level; }
+            const auto at = delta == span - 1 ? current + delta : t.due;
+            wheel[level][(at >> (slot_bits * level)) & (slots - 1)]
+                    .push_back(t);
+        }
+
+
+        inline void timer_wheel::advance(
+                uint64_t to, std::vector<std::unique_ptr<pending>> &due) {
+            while (current < to) {
+                ++current;
+                for (auto level = levels - 1; level; --level) {
+                    const auto block = uint64_t{1} << (slot_bits * level);
+                    if (not(current & (block - 1))) { cascade(level); }
+                }
+                auto &slot = wheel[0][current & (slots - 1)];
+                while (not slot.empty()) {
+                    auto &t = static_cast<timer &>(*slot.next);
+                    t.unlink();
+                    --count;
+                    due.push_back(std::move(t.waiting));
+                }
+            }
+        }
+
+
+    }
+
+
+}
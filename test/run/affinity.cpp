@@ -0,0 +1,59 @@
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <fstream>
+#include <iostream>
+
+
+int main() {
+    const f5::topology machine;
+    if (machine.nodes() < 1 || machine.cpus(0).empty()) { return 1; }
+    const auto first = machine.cpus(0).front();
+    if (machine.node_of(first) != machine.id(0)) { return 2; }
+
+    /// Node numbers can have gaps and nodes may have no CPUs. The
+    /// numbers reported are the kernel's own.
+    const auto sysfs =
+            std::filesystem::temp_directory_path() / "f5-threading-nodes";
+    std::filesystem::remove_all(sysfs);
+    for (auto node : {"node0", "node3", "possible"}) {
+        std::filesystem::create_directories(sysfs / node);
+    }
+    std::ofstream{sysfs / "node0" / "cpulist"} << "\n";
+    std::ofstream{sysfs / "node3" / "cpulist"} << first << "\n";
+    const f5::topology sparse{sysfs};
+    std::filesystem::remove_all(sysfs);
+    if (sparse.nodes() != 1 || sparse.id(0) != 3
+        || sparse.node_of(first) != std::size_t{3}) {
+        return 8;
+    }
+
+    /// Compact placement fills the first node before moving on
+    const auto compact = f5::placement::compact();
+    if (compact.cpus_for(0, machine) != std::vector<int>{first}) { return 3; }
+    /// Explicit sets wrap around
+    const auto sets = f5::placement::pinned({{first}, {first}});
+    if (sets.cpus_for(3, machine) != std::vector<int>{first}) { return 4; }
+    if (not f5::placement{}.cpus_for(0, machine).empty()) { return 5; }
+
+    /// Threads in a pinned pool only run on their CPU
+    f5::boost_asio::reactor_pool pool{
+            []() { return false; }, 2, f5::placement::spread()};
+    if (pool.node_of(0) != machine.id(0) || not pool.node_of(1)) {
+        return 6;
+    }
+    f5::sync s;
+    boost::asio::post(pool.get_io_service(), s([]() {
+                          cpu_set_t set;
+                          CPU_ZERO(&set);
+                          ::sched_getaffinity(0, sizeof(set), &set);
+                          if (CPU_COUNT(&set) != 1) {
+                              throw std::runtime_error{"Not pinned"};
+                          }
+                      }));
+    s.wait();
+
+    /// Unpinned pools don't know the node
+    f5::boost_asio::sharded_reactor_pool shards{[]() { return false; }, 1};
+    if (shards.node_of(0)) { return 7; }
+    return 0;
+}
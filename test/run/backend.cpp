@@ -0,0 +1,30 @@
+#include <f5/threading/queue.hpp>
+#include <cstring>
+#include <iostream>
+
+
+int main() {
+    const auto backend = f5::boost_asio::reactor_backend();
+#if defined(BOOST_ASIO_HAS_IO_URING)
+    if (std::strcmp(backend, "io_uring") != 0) { return 1; }
+#elif defined(__linux__)
+    if (std::strcmp(backend, "epoll") != 0) { return 1; }
+#endif
+
+    /// Signalling through the pipes works with whichever backend is used,
+    /// including when the signalling function has returned before the
+    /// write is done
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> q{ios};
+    for (int n{}; n < 1000; ++n) { q.produce(n); }
+    int total{};
+    boost::asio::spawn(ios, [&](auto yield) {
+        for (int n{}; n < 1000; ++n) { total += q.consume(yield); }
+    });
+    ios.run();
+    if (total != 999 * 1000 / 2) {
+        std::cout << backend << " total " << total << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <f5/threading/batch.hpp>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::batcher<int> batches{
+            ios, 3, std::chrono::milliseconds{20}};
+
+    /**
+        Two full batches go out straight away and the last item waits
+        for the delay. The memory from the first batch is reused.
+     */
+    std::vector<std::vector<int>> seen;
+    bool reused{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        for (int n{}; n < 3; ++n) { batches.produce(n); }
+        auto first = batches.consume(yield);
+        seen.push_back(first);
+        const auto memory = first.data();
+        batches.recycle(std::move(first));
+        for (int n = 3; n < 7; ++n) { batches.produce(n); }
+        auto second = batches.consume(yield);
+        seen.push_back(second);
+        const auto started = std::chrono::steady_clock::now();
+        auto third = batches.consume(yield);
+        if (std::chrono::steady_clock::now() - started
+            < std::chrono::milliseconds{10}) {
+            throw std::runtime_error("Partial batch sent too early");
+        }
+        seen.push_back(third);
+        reused = third.data() == memory;
+        batches.close();
+    });
+    ios.run();
+
+    if (seen != std::vector<std::vector<int>>{{0, 1, 2}, {3, 4, 5}, {6}}) {
+        std::cout << "Wrong batches" << std::endl;
+        return 1;
+    }
+    if (not reused) {
+        std::cout << "Recycled memory wasn't reused" << std::endl;
+        return 2;
+    }
+
+    /// Feeding stops when the source is closed and the partial batch
+    /// still goes out
+    f5::boost_asio::queue<int> source{ios};
+    f5::boost_asio::batcher<int> fed{ios, 10, std::chrono::seconds{10}};
+    std::vector<int> partial;
+    boost::asio::spawn(ios, [&](auto yield) {
+        source.produce(1);
+        source.produce(2);
+        boost::asio::post(ios, yield);
+        source.close();
+    });
+    boost::asio::spawn(ios, [&](auto yield) { fed.feed(source, yield); });
+    boost::asio::spawn(ios, [&](auto yield) {
+        partial = fed.consume(yield);
+        fed.close();
+    });
+    ios.restart();
+    ios.run();
+    if (partial != std::vector<int>{1, 2}) { return 3; }
+
+    /// The batcher is destroyed whilst the handler for its timer is
+    /// already queued
+    boost::asio::io_service late;
+    auto doomed = std::make_unique<f5::boost_asio::batcher<int>>(
+            late, 10, std::chrono::microseconds{1});
+    doomed->produce(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    boost::asio::post(late, [&]() { doomed.reset(); });
+    late.run();
+
+    return 0;
+}
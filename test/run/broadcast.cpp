@@ -0,0 +1,74 @@
+#include <f5/threading/broadcast.hpp>
+#include <iostream>
+#include <vector>
+
+
+int test_block() {
+    boost::asio::io_service ios;
+    f5::boost_asio::broadcast<int> bc{ios, 2};
+
+    /**
+        Every subscriber must see every item, in order, and they all
+        share the same instance of each item.
+     */
+    constexpr int subscribers = 3, items = 50;
+    std::vector<std::vector<int const *>> seen(subscribers);
+    for (auto &s : seen) {
+        boost::asio::spawn(ios, [&, sub = bc.subscribe()](auto yield) mutable {
+            for (int n{}; n < items; ++n) {
+                auto item = sub.consume(yield);
+                if (*item != n) { throw std::runtime_error("Out of order"); }
+                s.push_back(item.get());
+            }
+        });
+    }
+    boost::asio::spawn(ios, [&](auto yield) {
+        for (int n{}; n < items; ++n) { bc.produce(n, yield); }
+    });
+    ios.run();
+
+    for (auto &s : seen) {
+        if (s.size() != items) {
+            std::cout << "Subscriber saw " << s.size() << " items"
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (seen[0] != seen[1] || seen[0] != seen[2]) {
+        std::cout << "Items were copied per subscriber" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+
+int test_drop() {
+    boost::asio::io_service ios;
+    f5::boost_asio::broadcast<int> bc{
+            ios, 4, f5::boost_asio::lagging::drop};
+
+    /**
+        The subscriber doesn't consume anything until the producer has
+        finished, so it only gets to see the last few items.
+     */
+    auto sub = bc.subscribe();
+    std::vector<int> seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        for (int n{}; n < 10; ++n) { bc.produce(n, yield); }
+        while (seen.size() < 4) { seen.push_back(*sub.consume(yield)); }
+    });
+    ios.run();
+
+    if (seen != std::vector<int>{6, 7, 8, 9} || sub.missed() != 6) {
+        std::cout << "Lagging subscriber missed " << sub.missed()
+                  << " items" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+
+int main() {
+    if (auto r = test_block(); r) { return r; }
+    return test_drop();
+}
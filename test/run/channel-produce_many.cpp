@@ -0,0 +1,48 @@
+#include <f5/threading/channel.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::channel<int> chan{ios, 4};
+
+    /**
+        The producer pushes more items than the channel can hold so
+        it has to yield part way through the batch until the consumer
+        has made room.
+     */
+    std::vector<int> items{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    boost::asio::spawn(
+            ios, [&](auto yield) { chan.produce_many(items, yield); });
+
+    std::vector<int> consumed;
+    boost::asio::spawn(ios, [&](auto yield) {
+        while (consumed.size() < items.size()) {
+            consumed.push_back(chan.consume(yield));
+        }
+        chan.wait_for_all_outstanding(yield);
+    });
+    ios.run();
+
+    if (consumed != items) {
+        std::cout << "Items were not consumed in the order produced"
+                  << std::endl;
+        return 1;
+    }
+
+    /// Producing from an lvalue copies the items and leaves them alone
+    f5::boost_asio::queue<std::string> names{ios};
+    std::vector<std::string> originals{"first", "second"};
+    names.produce_many(originals);
+    if (originals != std::vector<std::string>{"first", "second"}) {
+        return 2;
+    }
+    names.produce_many(std::move(originals));
+    for (auto expected : {"first", "second", "first", "second"}) {
+        if (names.consume() != expected) { return 3; }
+    }
+
+    return 0;
+}
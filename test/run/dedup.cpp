@@ -0,0 +1,34 @@
+#include <f5/threading/dedup.hpp>
+#include <iostream>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::dedup_queue<int> q{ios};
+
+    /**
+        Duplicates of items that are waiting are dropped, but an item
+        can be queued again once it has been consumed.
+     */
+    for (int n : {3, 1, 3, 2, 1, 3}) { q.produce(n); }
+    std::vector<int> seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        seen.push_back(q.consume(yield));
+        q.produce(3);
+        while (seen.size() < 4) { seen.push_back(q.consume(yield)); }
+        q.close();
+    });
+    ios.run();
+
+    if (seen != std::vector<int>{3, 1, 2, 3}) {
+        std::cout << "Duplicates were not dropped" << std::endl;
+        return 1;
+    }
+    if (q.size()) {
+        std::cout << "Items left pending" << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <f5/threading/delay.hpp>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::delay_queue<int> q{ios};
+
+    /**
+        Items come out in the order they are due, not the order they
+        were produced in, and not before they are due.
+     */
+    using namespace std::chrono_literals;
+    const auto start = std::chrono::steady_clock::now();
+    q.produce(3, 30ms);
+    q.produce(1, 10ms);
+    q.produce(2, 20ms);
+    q.produce(0, 0ms);
+
+    std::vector<int> seen;
+    bool early{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        while (seen.size() < 4) {
+            seen.push_back(q.consume(yield));
+            const auto waited = std::chrono::steady_clock::now() - start;
+            if (waited < seen.back() * 10ms) { early = true; }
+        }
+        q.close();
+    });
+    ios.run();
+
+    if (seen != std::vector<int>{0, 1, 2, 3}) {
+        std::cout << "Items were not released in due order" << std::endl;
+        return 1;
+    }
+    if (early) {
+        std::cout << "An item was released early" << std::endl;
+        return 2;
+    }
+
+    /// The queue is destroyed whilst the handler for its timer is
+    /// already queued
+    boost::asio::io_service late;
+    auto doomed = std::make_unique<f5::boost_asio::delay_queue<int>>(late);
+    doomed->produce(1, 1us);
+    std::this_thread::sleep_for(1ms);
+    boost::asio::post(late, [&]() { doomed.reset(); });
+    late.run();
+
+    return 0;
+}
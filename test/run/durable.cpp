@@ -0,0 +1,102 @@
+#include <f5/threading/durable.hpp>
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <iostream>
+#include <fstream>
+
+
+namespace {
+    using queue_type = f5::boost_asio::durable_queue<int>;
+}
+
+
+int main() {
+    const auto directory =
+            std::filesystem::temp_directory_path() / "f5-threading-durable";
+    std::filesystem::remove_all(directory);
+
+    /// Produce some items from several coroutines, then only acknowledge
+    /// the even ones. The pool is declared first so that it outlives the
+    /// queue, and it is drained before the queue goes so that no handler
+    /// is still using the queue when it is destroyed.
+    {
+        f5::boost_asio::reactor_pool pool{[]() { return false; }, 2};
+        queue_type q{pool.get_io_service(), directory, 256};
+        for (int p{}; p < 4; ++p) {
+            boost::asio::spawn(pool.get_io_service(), [&, p](auto yield) {
+                for (int n{}; n < 25; ++n) { q.produce(p * 25 + n, yield); }
+            });
+        }
+        f5::sync s;
+        boost::asio::spawn(pool.get_io_service(), s([&](auto yield) {
+                               for (int n{}; n < 100; ++n) {
+                                   auto r = q.consume(yield);
+                                   if (r.value % 2 == 0) { q.ack(r.id); }
+                               }
+                           }));
+        s.wait();
+        q.close();
+        pool.drain(std::chrono::seconds{5});
+    }
+
+    /// Simulate a crash part way through writing a record
+    std::vector<std::filesystem::path> logs;
+    for (auto &entry : std::filesystem::directory_iterator{directory}) {
+        if (entry.path().extension() == ".log") {
+            logs.push_back(entry.path());
+        }
+    }
+    std::sort(logs.begin(), logs.end());
+    std::ofstream{logs.back(), std::ios::app} << "torn";
+    /// Files that aren't segments are ignored
+    std::ofstream{directory / "notes.log"} << "Not a segment";
+
+    /// Only the odd items come back, each exactly once
+    {
+        boost::asio::io_service ios;
+        queue_type q{ios, directory};
+        std::vector<bool> seen(100);
+        int count{};
+        while (auto r = q.consume()) {
+            if (r->value % 2 == 0 || seen[r->value]) {
+                std::cout << "Unexpected item " << r->value << std::endl;
+                return 2;
+            }
+            seen[r->value] = true;
+            ++count;
+            q.ack(r->id);
+        }
+        if (count != 50) {
+            std::cout << "Recovered " << count << " items" << std::endl;
+            return 3;
+        }
+        /// New items carry on after the recovered ones
+        boost::asio::spawn(ios, [&](auto yield) {
+            q.produce(100, yield);
+            auto r = q.consume(yield);
+            if (r.value != 100) { std::exit(4); }
+            q.ack(r.id);
+        });
+        ios.run();
+    }
+
+    /// Everything has been acknowledged so nothing is replayed
+    {
+        boost::asio::io_service ios;
+        queue_type q{ios, directory};
+        if (q.consume()) { return 5; }
+    }
+    /// The segments that were done with have been removed, leaving only
+    /// the last one started and the file that isn't a segment
+    std::size_t remaining{};
+    for (auto &entry : std::filesystem::directory_iterator{directory}) {
+        if (entry.path().extension() == ".log") { ++remaining; }
+    }
+    if (remaining != 2) {
+        std::cout << remaining << " log files left" << std::endl;
+        return 6;
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <f5/threading/event.hpp>
+#include <f5/threading/reactor.hpp>
+
+
+int main() {
+    /// Coroutines on a single threaded pool wait on an event that another
+    /// coroutine on the same thread finishes. With `f5::sync` this would
+    /// deadlock the pool.
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 1};
+    f5::boost_asio::event started, finished;
+    std::atomic<int> woken{};
+    for (int n{}; n < 3; ++n) {
+        boost::asio::spawn(pool.get_io_service(), [&](auto yield) {
+            started.wait(yield);
+            ++woken;
+            if (woken == 3) { finished.done(); }
+        });
+    }
+    boost::asio::spawn(pool.get_io_service(), [&](auto yield) {
+        boost::asio::steady_timer timer{pool.get_io_service()};
+        timer.expires_after(std::chrono::milliseconds{10});
+        timer.async_wait(yield);
+        started.done();
+    });
+    finished.wait();
+    if (woken != 3 || not started.is_done()) { return 1; }
+
+    /// Waiting on an event that is already done returns straight away
+    f5::boost_asio::event already;
+    already.done();
+    already.wait();
+    bool returned{false};
+    f5::boost_asio::event last;
+    boost::asio::spawn(pool.get_io_service(), last([&](auto yield) {
+                           already.wait(yield);
+                           returned = true;
+                       }));
+    last.wait();
+    if (not returned) { return 2; }
+
+    /// Exceptions are passed on to the waits
+    f5::boost_asio::event failed, handled;
+    bool caught{false};
+    boost::asio::spawn(pool.get_io_service(), handled([&](auto yield) {
+                           try {
+                               failed.wait(yield);
+                           } catch (std::runtime_error &) { caught = true; }
+                       }));
+    boost::asio::spawn(
+            pool.get_io_service(), failed([](auto) {
+                throw std::runtime_error{"Oops"};
+            }));
+    try {
+        failed.wait();
+        return 3;
+    } catch (std::runtime_error &) {}
+
+    handled.wait();
+    if (not caught) { return 4; }
+    pool.close();
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <boost/asio/spawn.hpp>
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+
+int main() {
+    /// Buckets are contiguous and between about 3% and 6% wide
+    for (uint64_t v : {0ul, 31ul, 32ul, 1000ul, 123456789ul, ~0ul}) {
+        const auto b = f5::histogram::bucket_of(v);
+        if (f5::histogram::lowest(b) > v
+            || (b + 1 < 976 && f5::histogram::lowest(b + 1) <= v)) {
+            std::cout << "Value " << v << " in wrong bucket " << b
+                      << std::endl;
+            return 1;
+        }
+    }
+    for (std::size_t b{32}; b + 1 < 976; ++b) {
+        const auto low = f5::histogram::lowest(b);
+        const auto width = f5::histogram::lowest(b + 1) - low;
+        if (low / width < 16 || low / width > 32) {
+            std::cout << "Bucket " << b << " is " << width << " wide from "
+                      << low << std::endl;
+            return 1;
+        }
+    }
+    f5::histogram h;
+    for (uint64_t v{1}; v <= 1000; ++v) { h.record(v); }
+    const auto values = h.snapshot();
+    const auto median = values.percentile(0.5);
+    if (values.count() != 1000 || median < 485 || median > 515) {
+        std::cout << "Median " << median << std::endl;
+        return 2;
+    }
+
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 2};
+    if (pool.instruments()) { return 3; }
+    std::atomic<int> long_handlers{};
+    std::mutex labelling;
+    std::multiset<std::string> labels;
+    f5::boost_asio::instrumentation_options options;
+    options.long_handler = std::chrono::milliseconds{5};
+    options.on_long_handler = [&](auto, std::string_view label) {
+        ++long_handlers;
+        std::lock_guard<std::mutex> lock{labelling};
+        labels.emplace(label);
+    };
+    options.lag_interval = std::chrono::milliseconds{1};
+    auto &instruments = pool.instrument(options);
+    /// Wait until both threads have started timing
+    while (instruments.snapshot().threads.size() < 2) {
+        boost::asio::post(pool.get_io_service(), []() {});
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    std::atomic<int> remaining{20};
+    f5::sync done;
+    for (int n{}; n < 20; ++n) {
+        pool.post([&, n]() {
+            if (n % 10 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+            if (--remaining == 0) { done.done(); }
+        });
+    }
+    done.wait();
+
+    /// Coroutines and handlers posted straight to the io_service are
+    /// measured too when a busy thread finds them. A coroutine can label
+    /// itself.
+    f5::boost_asio::reactor_pool single{[]() { return false; }, 1};
+    auto &alone = single.instrument(options);
+    f5::sync resumed, direct;
+    boost::asio::spawn(single.get_io_service(), resumed([&](auto yield) {
+                           boost::asio::post(single.get_io_service(), yield);
+                           f5::boost_asio::instrumentation::label("resumed");
+                           std::this_thread::sleep_for(
+                                   std::chrono::milliseconds{10});
+                       }));
+    resumed.wait();
+    single.post([&]() {
+        boost::asio::post(single.get_io_service(), [&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            direct.done();
+        });
+    });
+    direct.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    const auto stats = instruments.snapshot();
+    uint64_t ran{}, waited{}, counted_long{};
+    for (auto &t : stats.threads) {
+        ran += t.run.count();
+        waited += t.delay.count();
+        counted_long += t.long_handlers;
+    }
+    for (auto &t : alone.snapshot().threads) {
+        ran += t.run.count();
+        waited += t.delay.count();
+        counted_long += t.long_handlers;
+    }
+    if (ran < 23 || waited != 21 || counted_long != 4
+        || long_handlers != 4) {
+        std::cout << "Ran " << ran << " with " << counted_long << " long and "
+                  << waited << " waits" << std::endl;
+        return 5;
+    }
+    std::lock_guard<std::mutex> lock{labelling};
+    if (labels.count("resumed") != 1 || labels.count("") != 1
+        || std::none_of(labels.begin(), labels.end(), [](auto &l) {
+               return l.find("main") != std::string::npos;
+           })) {
+        for (auto &l : labels) { std::cout << "Label " << l << std::endl; }
+        return 7;
+    }
+    if (not stats.lag.count()) { return 6; }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <f5/threading/latch.hpp>
+#include <f5/threading/reactor.hpp>
+#include <vector>
+
+
+int main() {
+    /// Threads fan in on a latch
+    f5::boost_asio::latch fan_in{4};
+    std::atomic<int> arrived{};
+    std::vector<std::thread> threads;
+    for (int n{}; n < 4; ++n) {
+        threads.emplace_back([&]() {
+            ++arrived;
+            fan_in.count_down();
+        });
+    }
+    fan_in.wait();
+    if (arrived != 4 || not fan_in.try_wait()) { return 1; }
+    for (auto &t : threads) { t.join(); }
+    threads.clear();
+
+    /// Threads go through several phases of a barrier together
+    constexpr int phases = 100;
+    f5::boost_asio::barrier together{4};
+    std::atomic<int> progress{};
+    std::atomic<bool> overtaken{false};
+    for (int n{}; n < 4; ++n) {
+        threads.emplace_back([&]() {
+            for (int phase{}; phase < phases; ++phase) {
+                ++progress;
+                together.arrive_and_wait();
+                /// Everybody has finished this phase
+                if (progress < 4 * (phase + 1)) { overtaken = true; }
+                together.arrive_and_wait();
+            }
+        });
+    }
+    for (auto &t : threads) { t.join(); }
+    if (overtaken || progress != 4 * phases) { return 2; }
+
+    /// Coroutines on a single thread wait on a latch and a barrier
+    /// without blocking each other
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 1};
+    f5::boost_asio::latch ready{3}, finished{1};
+    f5::boost_asio::barrier step{3};
+    std::atomic<int> steps{};
+    for (int n{}; n < 3; ++n) {
+        boost::asio::spawn(pool.get_io_service(), [&](auto yield) {
+            ready.arrive_and_wait(yield);
+            for (int phase{}; phase < phases; ++phase) {
+                ++steps;
+                step.arrive_and_wait(yield);
+            }
+            if (steps == 3 * phases) { finished.count_down(); }
+        });
+    }
+    finished.wait();
+
+    /// A thread and a coroutine meet at a barrier
+    f5::boost_asio::barrier mixed{2};
+    f5::boost_asio::latch met{1};
+    boost::asio::spawn(pool.get_io_service(), [&](auto yield) {
+        mixed.arrive_and_wait(yield);
+        met.count_down();
+    });
+    mixed.arrive_and_wait();
+    met.wait();
+    pool.close();
+
+    /// Coroutines spread over several threads go through many phases
+    /// together. None of them may get into a phase early.
+    constexpr int parties = 8, many = 2000;
+    f5::boost_asio::reactor_pool threaded{[]() { return false; }, parties};
+    f5::boost_asio::barrier lockstep{parties};
+    f5::boost_asio::latch through{parties};
+    std::atomic<int> arrivals{};
+    std::atomic<bool> early{false};
+    for (int n{}; n < parties; ++n) {
+        boost::asio::spawn(threaded.get_io_service(), [&](auto yield) {
+            for (int phase{}; phase < many; ++phase) {
+                ++arrivals;
+                lockstep.arrive_and_wait(yield);
+                if (arrivals < parties * (phase + 1)) { early = true; }
+            }
+            through.count_down();
+        });
+    }
+    through.wait();
+    threaded.close();
+    if (early || arrivals != parties * many) { return 4; }
+
+    try {
+        f5::boost_asio::barrier empty{0};
+        return 3;
+    } catch (std::invalid_argument &) {}
+
+    return 0;
+}
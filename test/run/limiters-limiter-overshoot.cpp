@@ -0,0 +1,60 @@
+#include <f5/threading/limiters.hpp>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    constexpr uint64_t limit = 2;
+    f5::threading::fd::limiter throttle{ios, limit};
+
+    /**
+        Lots of coroutines on several threads take jobs at the same time
+        and hold them across a trip through the io_service, so jobs are
+        started and finished on different threads all the time. The
+        number of jobs held must never go over the limit, even when two
+        producers both see there is room for one more.
+     */
+    const auto threads =
+            std::max(4u, 2 * std::thread::hardware_concurrency());
+    const auto coroutines = 4 * threads;
+    constexpr int rounds = 2000;
+    std::atomic<uint64_t> held{}, highest{};
+    auto record = [&](uint64_t seen) {
+        for (auto high = highest.load();
+             seen > high && not highest.compare_exchange_weak(high, seen);) {}
+    };
+    for (unsigned c{}; c < coroutines; ++c) {
+        boost::asio::spawn(ios, [&](auto yield) {
+            for (int r{}; r < rounds; ++r) {
+                std::vector<std::unique_ptr<f5::threading::fd::limiter::job>>
+                        jobs;
+                if (r % 2) {
+                    jobs = throttle.next_jobs(limit, yield);
+                } else {
+                    jobs.push_back(throttle.next_job(yield));
+                }
+                record(held += jobs.size());
+                record(throttle.outstanding());
+                boost::asio::post(ios, yield);
+                held -= jobs.size();
+            }
+        });
+    }
+
+    std::vector<std::thread> running;
+    for (unsigned t{}; t < threads; ++t) {
+        running.emplace_back([&]() { ios.run(); });
+    }
+    for (auto &t : running) { t.join(); }
+
+    if (highest > limit) {
+        std::cout << "Limiter reached " << highest << " outstanding jobs"
+                  << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <f5/threading/parallel.hpp>
+#include <f5/threading/sync.hpp>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+
+
+int main() {
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 3};
+
+    /// Every index is visited exactly once
+    std::vector<std::atomic<int>> visits(10000);
+    f5::boost_asio::parallel_for(
+            pool, 0, visits.size(), [&](auto i) { ++visits[i]; });
+    for (auto &v : visits) {
+        if (v != 1) { return 1; }
+    }
+
+    std::vector<int> numbers(1000);
+    std::iota(numbers.begin(), numbers.end(), 1);
+    std::vector<long> squares(numbers.size());
+    const auto end = f5::boost_asio::parallel_transform(
+            pool, numbers.begin(), numbers.end(), squares.begin(),
+            [](int n) { return long{n} * n; });
+    if (end != squares.end() || squares[999] != 1000000) { return 2; }
+
+    /// Partial results are combined in order, so a reduction that isn't
+    /// commutative still works
+    const auto joined = f5::boost_asio::parallel_reduce(
+            pool, numbers.begin(), numbers.begin() + 100, std::string{},
+            [](std::string l, std::string r) { return l + r; },
+            [](int n) { return std::to_string(n % 10); });
+    std::string expected;
+    for (int n{1}; n <= 100; ++n) { expected += std::to_string(n % 10); }
+    if (joined != expected) {
+        std::cout << joined << std::endl;
+        return 3;
+    }
+    const auto sum = f5::boost_asio::parallel_reduce(
+            pool, numbers.begin(), numbers.end(), 0,
+            [](int l, int r) { return l + r; });
+    if (sum != 500500) { return 4; }
+
+    /// Exceptions come back to the caller
+    try {
+        f5::boost_asio::parallel_for(pool, 0, 1000, [](auto i) {
+            if (i == 500) { throw std::runtime_error{"500"}; }
+        });
+        return 5;
+    } catch (std::runtime_error &) {}
+
+    /// Calling from inside the pool doesn't deadlock, even when every
+    /// thread is doing it
+    std::atomic<int> inside{};
+    f5::sync done;
+    std::atomic<int> remaining{3};
+    for (int t{}; t < 3; ++t) {
+        boost::asio::post(pool.get_io_service(), [&]() {
+            f5::boost_asio::parallel_for(
+                    pool, 0, 1000, [&](auto) { ++inside; });
+            if (--remaining == 0) { done.done(); }
+        });
+    }
+    done.wait();
+    if (inside != 3000) { return 6; }
+
+    /// The caller does all of the work when the pool's threads are busy,
+    /// and the helpers are still safe when they run afterwards
+    std::promise<void> release;
+    std::shared_future<void> released{release.get_future()};
+    std::atomic<int> blocked{};
+    for (int t{}; t < 3; ++t) {
+        boost::asio::post(pool.get_io_service(), [&]() {
+            ++blocked;
+            released.wait();
+        });
+    }
+    while (blocked != 3) { std::this_thread::yield(); }
+    std::atomic<int> alone{};
+    f5::boost_asio::parallel_for(pool, 0, 1000, [&](auto) { ++alone; });
+    release.set_value();
+    if (alone != 1000) { return 7; }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <f5/threading/partitioned.hpp>
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+int main() {
+    constexpr std::size_t keys = 10, per_key = 50, consumers = 4;
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 4};
+    auto &ios = pool.get_io_service();
+    f5::boost_asio::partitioned_queue<std::size_t, std::size_t> q{ios, 4};
+
+    /**
+        Consumers on several threads check that each key's items arrive
+        in order and that no two of them ever work on the same lane at
+        the same time.
+     */
+    std::vector<std::size_t> last(keys);
+    std::vector<std::atomic<bool>> active(q.size());
+    std::atomic<std::size_t> processed{};
+    std::atomic<bool> failed{false};
+    std::vector<f5::sync> finished(consumers);
+    for (auto &f : finished) {
+        boost::asio::spawn(ios, f([&](auto yield) {
+            while (processed < keys * per_key) {
+                auto i = q.consume(yield);
+                if (i.value() >= keys * per_key) { break; }
+                if (active[i.lane()].exchange(true)) { failed = true; }
+                const auto key = i.value() % keys, seq = i.value() / keys;
+                if (seq && last[key] != seq - 1) { failed = true; }
+                last[key] = seq;
+                std::this_thread::yield();
+                active[i.lane()] = false;
+                /// Wake the others up so they can exit
+                if (++processed == keys * per_key) {
+                    for (std::size_t c{}; c < consumers; ++c) {
+                        q.produce(c, keys * per_key * 2);
+                    }
+                }
+            }
+        }));
+    }
+    for (std::size_t n{}; n < keys * per_key; ++n) { q.produce(n % keys, n); }
+    for (auto &f : finished) { f.wait(); }
+
+    if (failed) {
+        std::cout << "Per key ordering was broken" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
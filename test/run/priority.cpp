@@ -0,0 +1,57 @@
+#include <f5/threading/priority.hpp>
+#include <iostream>
+#include <vector>
+
+
+int test_lanes() {
+    boost::asio::io_service ios;
+    f5::boost_asio::priority_queue<char, 3> q{
+            ios, f5::boost_asio::priority_lanes<char, 3>{2}};
+
+    /**
+        The high priority items go first, but the other lanes get a
+        look in after being passed over twice, highest priority first.
+     */
+    for (char c : {'a', 'b', 'c', 'd'}) { q.produce({0, c}); }
+    q.produce({2, 'z'});
+    q.produce({1, 'm'});
+
+    std::string seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        while (seen.size() < 6) { seen += q.consume(yield).second; }
+        q.close();
+    });
+    ios.run();
+
+    if (seen != "abmzcd") {
+        std::cout << "Lanes were served as " << seen << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_heap() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int, f5::boost_asio::priority_heap<int>> q{ios};
+
+    for (int n : {3, 1, 4, 1, 5, 9, 2, 6}) { q.produce(n); }
+    std::vector<int> seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        while (seen.size() < 8) { seen.push_back(q.consume(yield)); }
+        q.close();
+    });
+    ios.run();
+
+    if (seen != std::vector<int>{9, 6, 5, 4, 3, 2, 1, 1}) {
+        std::cout << "Heap order is wrong" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+
+int main() {
+    if (auto r = test_lanes(); r) { return r; }
+    return test_heap();
+}
@@ -0,0 +1,44 @@
+#include <f5/threading/reactor.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <iostream>
+
+
+int main() {
+    /// Queued handlers and coroutines run to completion
+    {
+        f5::boost_asio::reactor_pool pool{[]() { return false; }, 2};
+        std::atomic<int> ran{}, resumed{};
+        for (int n{}; n < 100; ++n) { pool.post([&]() { ++ran; }); }
+        for (int n{}; n < 10; ++n) {
+            boost::asio::spawn(pool.get_io_service(), [&](auto yield) {
+                boost::asio::steady_timer timer{pool.get_io_service()};
+                timer.expires_after(std::chrono::milliseconds{20});
+                timer.async_wait(yield);
+                ++resumed;
+            });
+        }
+        if (not pool.drain(std::chrono::seconds{5})) { return 1; }
+        if (ran != 100 || resumed != 10) {
+            std::cout << "Ran " << ran << " resumed " << resumed << std::endl;
+            return 2;
+        }
+        /// New work is refused
+        if (pool.post([]() {})) { return 3; }
+    }
+
+    /// Work that doesn't finish in time is abandoned at the deadline
+    {
+        f5::boost_asio::reactor_pool pool{[]() { return false; }, 1};
+        boost::asio::steady_timer never{pool.get_io_service()};
+        never.expires_after(std::chrono::hours{1});
+        never.async_wait([](auto) {});
+        const auto started = std::chrono::steady_clock::now();
+        if (pool.drain(std::chrono::milliseconds{50})) { return 4; }
+        if (std::chrono::steady_clock::now() - started
+            > std::chrono::seconds{5}) {
+            return 5;
+        }
+    }
+    return 0;
+}
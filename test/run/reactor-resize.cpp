@@ -0,0 +1,87 @@
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <boost/asio/spawn.hpp>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace {
+    /// Wait for the pool to reach the size
+    bool settles(f5::boost_asio::reactor_pool &pool, std::size_t size) {
+        for (int tries{}; tries < 2000; ++tries) {
+            if (pool.size() == size) { return true; }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        std::cout << "Pool has " << pool.size() << " threads, expected "
+                  << size << std::endl;
+        return false;
+    }
+}
+
+
+int main() {
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 2};
+
+    /// A coroutine that is running whilst the pool is resized carries on
+    std::atomic<bool> stop{false};
+    f5::sync running;
+    boost::asio::spawn(
+            pool.get_io_service(), running([&](auto yield) {
+                boost::asio::steady_timer timer{pool.get_io_service()};
+                while (not stop) {
+                    timer.expires_after(std::chrono::milliseconds{1});
+                    timer.async_wait(yield);
+                }
+            }));
+
+    pool.grow(3);
+    if (not settles(pool, 5)) { return 1; }
+    pool.shrink(3);
+    if (not settles(pool, 2)) { return 2; }
+    /// Never shrinks to nothing
+    pool.shrink(10);
+    if (not settles(pool, 1)) { return 3; }
+    pool.grow(1);
+    if (not settles(pool, 2)) { return 4; }
+
+    /// With nothing to do automatic sizing drops to the minimum
+    pool.autosize(1, 4, std::chrono::milliseconds{50},
+                  std::chrono::milliseconds{1});
+    if (not settles(pool, 1)) { return 5; }
+
+    stop = true;
+    running.wait();
+
+    /// Another thread running the io_service whilst the pool shrinks is
+    /// left alone, and the threads that are left keep their numbers
+    f5::boost_asio::reactor_pool shared{[]() { return false; }, 4};
+    std::atomic<bool> escaped{false};
+    std::thread outsider{[&]() {
+        try {
+            shared.get_io_service().run();
+        } catch (...) { escaped = true; }
+    }};
+    for (int n{}; n < 100; ++n) {
+        shared.post([]() {});
+        shared.shrink(1);
+        shared.grow(1);
+    }
+    shared.shrink(3);
+    if (not settles(shared, 1)) { return 6; }
+    shared.grow(0);
+    for (std::size_t t{}; t != 4; ++t) {
+        shared.spin(t, std::chrono::nanoseconds{});
+        shared.spin_time(t);
+    }
+    shared.node_of(3);
+    shared.close();
+    outsider.join();
+    if (escaped) { return 7; }
+    /// Once closed the pool has no threads to ask about
+    try {
+        shared.node_of(0);
+        return 8;
+    } catch (std::out_of_range &) {}
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+
+int main() {
+    f5::boost_asio::sharded_reactor_pool pool{[]() { return false; }, 3};
+    if (pool.size() != 3) { return 1; }
+
+    /// Each shard has a single thread which is always the same one
+    std::mutex mtx;
+    std::set<std::thread::id> ids[3];
+    std::atomic<int> remaining{300};
+    f5::sync finished;
+    for (int n{}; n < 300; ++n) {
+        pool.post(n, [&, n]() {
+            {
+                std::lock_guard<std::mutex> lock{mtx};
+                ids[n % 3].insert(std::this_thread::get_id());
+            }
+            if (--remaining == 0) { finished.done(); }
+        });
+    }
+    finished.wait();
+    std::set<std::thread::id> all;
+    for (auto &s : ids) {
+        if (s.size() != 1) {
+            std::cout << "Shard ran on " << s.size() << " threads" << std::endl;
+            return 2;
+        }
+        all.insert(*s.begin());
+    }
+    if (all.size() != 3) { return 3; }
+
+    /// Round-robin visits every shard in turn
+    if (&pool.next_io_service() == &pool.next_io_service()) { return 4; }
+    if (&pool.get_io_service(1) != &pool.get_io_service(4)) { return 5; }
+
+    /// Shards can post to each other
+    f5::sync hopped;
+    pool.post(0, [&]() { pool.post(2, [&]() { hopped.done(); }); });
+    hopped.wait();
+    return 0;
+}
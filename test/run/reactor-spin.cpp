@@ -0,0 +1,49 @@
+#include <f5/threading/reactor.hpp>
+#include <f5/threading/sync.hpp>
+#include <iostream>
+#include <stdexcept>
+
+
+int main() {
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 1};
+    pool.spin(0, std::chrono::milliseconds{5});
+
+    /// Wake the thread up so it sees the budget, then give it handlers
+    /// to find whilst it is spinning
+    for (int n{}; n < 20; ++n) {
+        f5::sync ran;
+        pool.post(ran([]() {}));
+        ran.wait();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    const auto spun = pool.spin_time(0);
+    if (not spun.spinning.count() || not spun.handlers) {
+        std::cout << "Spun " << spun.spinning.count() << "ns for "
+                  << spun.handlers << " handlers" << std::endl;
+        return 1;
+    }
+
+    /// Turning spinning off goes back to blocking
+    pool.spin(0, {});
+    f5::sync ran;
+    pool.post(ran([]() {}));
+    ran.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto before = pool.spin_time(0).spinning;
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    if (pool.spin_time(0).spinning != before) { return 2; }
+
+    /// Threads that don't exist are reported, including once the pool
+    /// has been closed
+    try {
+        pool.spin(1, {});
+        return 3;
+    } catch (std::out_of_range &) {}
+    pool.close();
+    try {
+        pool.spin_time(0);
+        return 4;
+    } catch (std::out_of_range &) {}
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <f5/threading/rendezvous.hpp>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::rendezvous<std::unique_ptr<int>> meet{ios};
+
+    /**
+        Several producers and consumers hand move-only values over
+        across a number of threads.
+     */
+    constexpr int producers = 4, consumers = 3, per_producer = 200;
+    std::atomic<int> total{}, finished{};
+    for (int p{}; p < producers; ++p) {
+        boost::asio::spawn(ios, [&](auto yield) {
+            for (int n{}; n < per_producer; ++n) {
+                meet.produce(std::make_unique<int>(1), yield);
+            }
+            /// The last producer tells the consumers to stop
+            if (++finished == producers) {
+                for (int c{}; c < consumers; ++c) {
+                    meet.produce(nullptr, yield);
+                }
+            }
+        });
+    }
+    for (int c{}; c < consumers; ++c) {
+        boost::asio::spawn(ios, [&](auto yield) {
+            while (auto v = meet.consume(yield)) { total += *v; }
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (int t{}; t < 4; ++t) {
+        threads.emplace_back([&]() { ios.run(); });
+    }
+    for (auto &t : threads) { t.join(); }
+
+    if (total != producers * per_producer) {
+        std::cout << "Handed over " << total << " items" << std::endl;
+        return 1;
+    }
+
+    /// Closing wakes the coroutines that are waiting with an error
+    boost::asio::io_service closing;
+    f5::boost_asio::rendezvous<int> shut{closing};
+    int aborted{};
+    for (int n{}; n < 2; ++n) {
+        boost::asio::spawn(closing, [&](auto yield) {
+            try {
+                shut.consume(yield);
+            } catch (boost::system::system_error &) { ++aborted; }
+        });
+    }
+    boost::asio::spawn(closing, [&](auto yield) {
+        boost::asio::post(closing, yield);
+        shut.close();
+        try {
+            shut.produce(1, yield);
+        } catch (boost::system::system_error &) { ++aborted; }
+    });
+    closing.run();
+    if (aborted != 3) { return 2; }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <f5/threading/reorder.hpp>
+#include <iostream>
+#include <vector>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> out{ios};
+    f5::boost_asio::reorder<int> restore{ios, out, 4};
+
+    /**
+        The first ticket holder doesn't insert its item until the
+        window is full and another coroutine is waiting for a ticket.
+     */
+    bool blocked{true};
+    std::vector<int> seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        std::vector<f5::boost_asio::reorder<int>::ticket> tickets;
+        for (int n{}; n < 4; ++n) { tickets.push_back(restore.next(yield)); }
+        boost::asio::spawn(ios, [&](auto yield) {
+            auto late = restore.next(yield);
+            blocked = false;
+            const int value = late.sequence();
+            restore.insert(std::move(late), value, yield);
+        });
+        /// Let the other coroutine run until it has to wait
+        boost::asio::post(ios, yield);
+        if (not blocked) { throw std::runtime_error("Window overflowed"); }
+        for (int n = 3; n >= 0; --n) {
+            restore.insert(std::move(tickets[n]), n, yield);
+        }
+        while (seen.size() < 5) { seen.push_back(out.consume(yield)); }
+    });
+    ios.run();
+
+    if (seen != std::vector<int>{0, 1, 2, 3, 4}) {
+        std::cout << "Items were not put back in order" << std::endl;
+        return 1;
+    }
+
+    /**
+        A ticket that is dropped without its item being inserted is
+        skipped. The items after it that have already arrived are
+        released, and later tickets that reuse its place in the window
+        still come out in order.
+     */
+    std::vector<int> kept;
+    boost::asio::spawn(ios, [&](auto yield) {
+        std::vector<f5::boost_asio::reorder<int>::ticket> tickets;
+        for (int n{}; n < 3; ++n) { tickets.push_back(restore.next(yield)); }
+        const int first = tickets[0].sequence();
+        restore.insert(std::move(tickets[2]), first + 2, yield);
+        restore.insert(std::move(tickets[0]), first, yield);
+        tickets.clear();
+        for (int n = 3; n < 10; ++n) {
+            auto t = restore.next(yield);
+            if (n == 6) { continue; }
+            restore.insert(std::move(t), first + n, yield);
+        }
+        while (kept.size() < 8) { kept.push_back(out.consume(yield)); }
+    });
+    ios.restart();
+    ios.run();
+
+    if (kept != std::vector<int>{5, 7, 8, 9, 10, 12, 13, 14}) {
+        for (auto k : kept) { std::cout << k << ' '; }
+        std::cout << "\nItems around a dropped ticket were wrong"
+                  << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <f5/threading/select.hpp>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+int test_fairness() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> busy{ios}, quiet{ios};
+    for (int n{}; n < 10; ++n) { busy.produce(n); }
+    quiet.produce(100);
+    quiet.produce(101);
+
+    /**
+        Even though the first queue has plenty of items the second one
+        must get a look in.
+     */
+    std::vector<std::size_t> order;
+    boost::asio::spawn(ios, [&](auto yield) {
+        {
+            f5::boost_asio::select<int> sel{ios, busy, quiet};
+            for (int n{}; n < 4; ++n) {
+                order.push_back(sel.consume(yield).first);
+            }
+        }
+        busy.close();
+        quiet.close();
+    });
+    ios.run();
+
+    if (order != std::vector<std::size_t>{0, 1, 0, 1}) {
+        std::cout << "Sources weren't served in turn" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_waiting() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> q{ios};
+    f5::boost_asio::channel<int> c{ios, 2};
+
+    /**
+        The consumer starts before anything is available so it has to
+        be woken by whichever source gets an item.
+     */
+    int total{};
+    boost::asio::spawn(ios, [&](auto yield) {
+        {
+            f5::boost_asio::select<int> sel{ios, q, c};
+            for (int n{}; n < 6; ++n) { total += sel.consume(yield).second; }
+        }
+        q.close();
+        c.close();
+    });
+    boost::asio::spawn(ios, [&](auto yield) {
+        for (int n{}; n < 3; ++n) {
+            c.produce(1, yield);
+            q.produce(10);
+        }
+    });
+    ios.run();
+
+    if (total != 33) {
+        std::cout << "Select consumed a total of " << total << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+
+int test_closed() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> full{ios}, empty{ios};
+    for (int n{}; n < 3; ++n) { full.produce(n); }
+    full.close();
+    empty.close();
+
+    /**
+        Items still in a closed source are delivered before the select
+        reports that everything is closed.
+     */
+    int total{};
+    bool aborted{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        f5::boost_asio::select<int> sel{ios, full, empty};
+        /// Let the select find out that its sources are closed
+        boost::asio::post(ios, yield);
+        try {
+            while (true) { total += 1 + sel.consume(yield).second; }
+        } catch (boost::system::system_error &) { aborted = true; }
+    });
+    ios.run();
+
+    if (total != 6 || not aborted) {
+        std::cout << "Closed sources gave a total of " << total << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+
+int test_threads() {
+    boost::asio::io_service ios;
+    f5::boost_asio::queue<int> first{ios}, second{ios};
+
+    /**
+        Producers on different threads fill their queues and close them.
+        Closing a queue isn't safe whilst other threads are using it, so
+        only then do the consumers start, each with its own select, and
+        they have to drain everything that was left behind.
+     */
+    constexpr int per_producer = 2000, consumers = 3;
+    std::atomic<int> total{}, aborted{}, closed{};
+    auto consume = [&](auto yield) {
+        f5::boost_asio::select<int> sel{ios, first, second};
+        try {
+            while (true) {
+                total += sel.consume(yield).second;
+                boost::asio::post(ios, yield);
+            }
+        } catch (boost::system::system_error &) { ++aborted; }
+    };
+    for (auto *q : {&first, &second}) {
+        boost::asio::spawn(ios, [&, q](auto yield) {
+            for (int n{}; n < per_producer; ++n) {
+                q->produce(1);
+                if (n % 10 == 0) { boost::asio::post(ios, yield); }
+            }
+            q->close();
+            if (++closed == 2) {
+                for (int c{}; c < consumers; ++c) {
+                    boost::asio::spawn(ios, consume);
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> threads;
+    for (int t{}; t < 4; ++t) {
+        threads.emplace_back([&]() { ios.run(); });
+    }
+    for (auto &t : threads) { t.join(); }
+
+    if (total != 2 * per_producer || aborted != consumers) {
+        std::cout << "Threaded select consumed " << total << std::endl;
+        return 4;
+    }
+    return 0;
+}
+
+
+int main() {
+    if (auto r = test_fairness(); r) { return r; }
+    if (auto r = test_waiting(); r) { return r; }
+    if (auto r = test_closed(); r) { return r; }
+    return test_threads();
+}
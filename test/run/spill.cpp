@@ -0,0 +1,70 @@
+#include <f5/threading/spill.hpp>
+#include <iostream>
+#include <vector>
+
+
+/// Serialiser for strings, which aren't trivially copyable
+struct string_serialiser {
+    void save(const std::string &s, std::string &into) const { into += s; }
+    std::string load(std::string_view from) const {
+        return std::string{from};
+    }
+};
+
+
+int test_store() {
+    f5::boost_asio::spilling_store<std::string, string_serialiser> store{
+            2, 3};
+
+    /**
+        Most of the items end up in the file, but they come back in the
+        order they went in. The file is reused after it's emptied.
+     */
+    for (int round{}; round < 2; ++round) {
+        for (int n{}; n < 100; ++n) { store.push_back(std::to_string(n)); }
+        if (store.size() != 100 || store.spilled_size() < 90) {
+            std::cout << "Only " << store.spilled_size() << " spilled"
+                      << std::endl;
+            return 1;
+        }
+        for (int n{}; n < 100; ++n) {
+            if (store.front() != std::to_string(n)) {
+                std::cout << "Expected " << n << " got " << store.front()
+                          << std::endl;
+                return 2;
+            }
+            store.pop_front();
+        }
+        if (store.size()) { return 3; }
+    }
+    return 0;
+}
+
+
+int test_queue() {
+    boost::asio::io_service ios;
+    using store_type = f5::boost_asio::spilling_store<int>;
+    f5::boost_asio::queue<int, store_type> q{ios, store_type{4, 4}};
+
+    for (int n{}; n < 1000; ++n) { q.produce(n); }
+    std::vector<int> seen;
+    boost::asio::spawn(ios, [&](auto yield) {
+        while (seen.size() < 1000) { seen.push_back(q.consume(yield)); }
+        q.close();
+    });
+    ios.run();
+
+    for (int n{}; n < 1000; ++n) {
+        if (seen[n] != n) {
+            std::cout << "Queue returned items out of order" << std::endl;
+            return 4;
+        }
+    }
+    return 0;
+}
+
+
+int main() {
+    if (auto r = test_store(); r) { return r; }
+    return test_queue();
+}
@@ -0,0 +1,96 @@
+#include <f5/threading/stealing.hpp>
+#include <boost/asio/io_service.hpp>
+#include <future>
+#include <iostream>
+
+
+namespace {
+    /// Recursive fork that puts lots of tasks on the workers' own deques
+    void fork(
+            f5::boost_asio::stealing_pool &pool,
+            std::atomic<int> &leaves,
+            int depth) {
+        if (depth == 0) {
+            ++leaves;
+        } else {
+            for (int n{}; n < 2; ++n) {
+                pool.post([&pool, &leaves, depth]() {
+                    fork(pool, leaves, depth - 1);
+                });
+            }
+        }
+    }
+}
+
+
+int main() {
+    /// The deque on its own, including growing
+    f5::stealing_deque<int> deque{2};
+    int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (auto &v : values) { deque.push(&v); }
+    if (deque.steal() != &values[0]) { return 1; }
+    if (deque.pop() != &values[9]) { return 2; }
+    int count{};
+    while (deque.pop()) { ++count; }
+    if (count != 8 || deque.steal()) { return 3; }
+
+    f5::boost_asio::stealing_pool pool{[]() { return false; }, 3};
+
+    /// Post through the executor and from inside the pool
+    std::atomic<int> leaves{};
+    boost::asio::post(pool.get_executor(), [&]() { fork(pool, leaves, 10); });
+
+    /// Hand work over from a coroutine and back again
+    boost::asio::io_service ios;
+    std::thread::id reactor;
+    int answer{};
+    bool caught{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        reactor = std::this_thread::get_id();
+        answer = pool.run(
+                [&]() {
+                    if (pool.running_in_this_thread()) { return 42; }
+                    return 0;
+                },
+                yield);
+        if (std::this_thread::get_id() != reactor) { answer = -1; }
+        pool.run([]() {}, yield);
+        try {
+            pool.run([]() { throw std::runtime_error{"Oops"}; }, yield);
+        } catch (std::runtime_error &) { caught = true; }
+    });
+    ios.run();
+    if (answer != 42) {
+        std::cout << "Answer was " << answer << std::endl;
+        return 4;
+    }
+    if (not caught) { return 5; }
+
+    while (leaves != 1024) { std::this_thread::yield(); }
+
+    /// A coroutine waiting on a hand-off carries on when the pool is
+    /// closed before the function has been run
+    std::promise<void> stopped;
+    f5::boost_asio::stealing_pool halted{
+            [&]() {
+                stopped.set_value();
+                return false;
+            },
+            1};
+    halted.post([]() { throw std::runtime_error{"Stop"}; });
+    stopped.get_future().wait();
+    bool ran{false}, aborted{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        try {
+            halted.run([&]() { ran = true; }, yield);
+        } catch (boost::system::system_error &e) {
+            aborted = e.code() == boost::asio::error::operation_aborted;
+        }
+    });
+    ios.restart();
+    ios.poll();
+    halted.close();
+    ios.run();
+    if (ran || not aborted) { return 6; }
+    return 0;
+}
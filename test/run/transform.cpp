@@ -0,0 +1,115 @@
+#include <f5/threading/sync.hpp>
+#include <f5/threading/transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+
+std::vector<int> run(f5::boost_asio::ordering order) {
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 4};
+    auto &ios = pool.get_io_service();
+    f5::boost_asio::channel<int> in{ios, 4};
+    f5::boost_asio::channel<int> out{ios, 4};
+
+    /**
+        The later items are quicker to process than the earlier ones
+        so they will finish out of order.
+     */
+    constexpr int items = 40;
+    f5::boost_asio::transform(
+            pool, in, out,
+            [](int v) {
+                std::this_thread::sleep_for(
+                        std::chrono::microseconds((items - v) * 50));
+                return v * v;
+            },
+            3, order);
+
+    f5::sync produced, consumed;
+    boost::asio::spawn(ios, produced([&](auto yield) {
+                           for (int n{}; n < items; ++n) {
+                               in.produce(n, yield);
+                           }
+                       }));
+    std::vector<int> results;
+    boost::asio::spawn(ios, consumed([&](auto yield) {
+                           while (results.size() < items) {
+                               results.push_back(out.consume(yield));
+                           }
+                       }));
+    produced.wait();
+    consumed.wait();
+    return results;
+}
+
+
+int failing() {
+    f5::boost_asio::reactor_pool pool{[]() { return false; }, 1};
+    auto &ios = pool.get_io_service();
+    f5::boost_asio::channel<int> in{ios, 4};
+    f5::boost_asio::channel<int> out{ios, 4};
+
+    /**
+        The function throws part way through. The exception goes to the
+        caller through the returned future and the channels are left
+        open for their owner to close.
+     */
+    auto finished = f5::boost_asio::transform(
+            pool, in, out,
+            [](int v) {
+                if (v == 5) { throw std::runtime_error{"Oops"}; }
+                return v;
+            },
+            2);
+
+    f5::sync produced, consumed;
+    boost::asio::spawn(ios, produced([&](auto yield) {
+                           for (int n{}; n < 10; ++n) { in.produce(n, yield); }
+                       }));
+    std::atomic<int> received{};
+    boost::asio::spawn(ios, consumed([&](auto yield) {
+                           try {
+                               while (true) {
+                                   out.consume(yield);
+                                   ++received;
+                               }
+                           } catch (boost::system::system_error &) {}
+                       }));
+    try {
+        finished.get();
+        return 3;
+    } catch (std::runtime_error &) {}
+    produced.wait();
+
+    /// Nothing after the failure is produced. The owner closes the
+    /// channels from the pool's thread so that nothing else is using
+    /// them at the time.
+    boost::asio::post(ios, [&]() {
+        in.close();
+        out.close();
+    });
+    consumed.wait();
+    if (received > 5) { return 4; }
+    return 0;
+}
+
+
+int main() {
+    std::vector<int> expected;
+    for (int n{}; n < 40; ++n) { expected.push_back(n * n); }
+
+    if (run(f5::boost_asio::ordering::preserved) != expected) {
+        std::cout << "Order was not preserved" << std::endl;
+        return 1;
+    }
+
+    auto unordered = run(f5::boost_asio::ordering::unordered);
+    std::sort(unordered.begin(), unordered.end());
+    if (unordered != expected) {
+        std::cout << "Unordered results are wrong" << std::endl;
+        return 2;
+    }
+
+    return failing();
+}
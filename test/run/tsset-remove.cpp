@@ -0,0 +1,25 @@
+#include <f5/threading/set.hpp>
+#include <iostream>
+
+
+int main() {
+    f5::tsset<int> set;
+    set.insert_if_not_found(1);
+    set.insert_if_not_found(3);
+
+    /// Removing a value that isn't there leaves the one after it alone
+    if (set.remove(2)) {
+        std::cout << "Removed a value that wasn't in the set" << std::endl;
+        return 1;
+    }
+    if (set.size() != 2) {
+        std::cout << "The set now has " << set.size() << " items"
+                  << std::endl;
+        return 2;
+    }
+
+    if (not set.remove(3) || set.size() != 1) { return 3; }
+    if (not set.remove(1) || set.size() != 0) { return 4; }
+
+    return 0;
+}
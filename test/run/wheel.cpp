@@ -0,0 +1,91 @@
+#include <f5/threading/wheel.hpp>
+#include <boost/asio/spawn.hpp>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <thread>
+
+
+int main() {
+    boost::asio::io_service ios;
+    f5::boost_asio::timer_wheel wheel{ios, std::chrono::microseconds{20}};
+
+    /// Lots of timers, half of which are cancelled before they are due.
+    /// Those are further off than the wheel can hold directly.
+    std::list<f5::boost_asio::timer_wheel::timer> timers;
+    int fired{}, aborted{};
+    for (int n{}; n < 10000; ++n) {
+        auto &t = timers.emplace_back(wheel);
+        t.expires_after(std::chrono::milliseconds{n % 2 ? 10 : 100000});
+        t.async_wait([&](auto error) {
+            if (error == boost::asio::error::operation_aborted) {
+                ++aborted;
+            } else {
+                ++fired;
+            }
+        });
+    }
+    if (wheel.size() != 10000) { return 1; }
+
+    /// Coroutines wait in order of their due times. At this resolution
+    /// they start off in different levels of the wheel.
+    std::vector<int> order;
+    for (int n : {150, 5, 70}) {
+        boost::asio::spawn(ios, [&, n](auto yield) {
+            f5::boost_asio::timer_wheel::timer t{wheel};
+            const auto started = std::chrono::steady_clock::now();
+            t.expires_after(std::chrono::milliseconds{n});
+            t.async_wait(yield);
+            if (std::chrono::steady_clock::now() - started
+                < std::chrono::milliseconds{n}) {
+                std::cout << "Timer " << n << " fired early" << std::endl;
+                std::exit(2);
+            }
+            order.push_back(n);
+            if (order.size() == 3) {
+                /// The long timers are the even ones
+                int index{};
+                for (auto &t : timers) {
+                    if (index++ % 2 == 0) { t.cancel(); }
+                }
+            }
+        });
+    }
+    /// A cancelled coroutine wait throws
+    bool threw{false};
+    boost::asio::spawn(ios, [&](auto yield) {
+        f5::boost_asio::timer_wheel::timer t{wheel};
+        t.expires_after(std::chrono::seconds{10});
+        boost::asio::post(ios, [&]() { t.cancel(); });
+        try {
+            t.async_wait(yield);
+        } catch (boost::system::system_error &) { threw = true; }
+    });
+
+    ios.run();
+    if (order != std::vector<int>{5, 70, 150}) { return 3; }
+    if (fired != 5000 || aborted != 5000) {
+        std::cout << fired << " fired and " << aborted << " aborted"
+                  << std::endl;
+        return 4;
+    }
+    if (not threw || wheel.size()) { return 5; }
+
+    /// The wheel is destroyed whilst the handler for its driver is
+    /// already queued
+    boost::asio::io_service late;
+    auto doomed = std::make_unique<f5::boost_asio::timer_wheel>(
+            late, std::chrono::microseconds{1});
+    auto waiting =
+            std::make_unique<f5::boost_asio::timer_wheel::timer>(*doomed);
+    waiting->expires_after(std::chrono::seconds{10});
+    waiting->async_wait([](auto) {});
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    boost::asio::post(late, [&]() {
+        waiting.reset();
+        doomed.reset();
+    });
+    late.run();
+
+    return 0;
+}